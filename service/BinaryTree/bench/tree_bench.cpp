@@ -0,0 +1,717 @@
+/**
+ * @file tree_bench.cpp
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief BinaryTree 微基准
+            ===============
+            每个用例输出一行 JSON，便于多次运行对比.
+            编译: g++ -O2 -std=c++11 -I../include tree_bench.cpp -o tree_bench -lpthread
+            > * insert/find: 顺序、逆序、随机三种输入下的插入与查找，与不做平衡的二叉搜索树、std::multiset对比
+            > * scan/clear: 按键的顺序逐个查找(近似中序遍历的访存)与整棵树的释放
+            > * avl_pool为默认的块分配结点，avl_new为每个结点单独new/delete
+            > * rank: RankedTree的插入开销，rank/select/count_range与遍历计数对比
+            > * frozen: 由同一棵树构造FrozenTree，随机键的查找与lower_bound，与指针树对比
+            > * mapped: 逐个insert重建与保存、打开映射文件、首次查询、随机查询(有/无索引)、转换回树的耗时
+            > * concurrent: 1~t个读线程随机查找，同时一个写线程不停插入删除，ConcurrentTree与加读写锁的BinaryTree对比
+            > * bulk: 有序/随机(含重复)输入下bulk_load与逐个insert建树对比
+            > * iter: 随机插入建树后用迭代器完整遍历一次，以及复制整棵树，与std::multiset对比
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <vector>
+#include <set>
+#include <random>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <pthread.h>
+
+#include "BinaryTree.hpp"
+#include "FrozenTree.hpp"
+#include "ConcurrentTree.hpp"
+#include "MappedTree.hpp"
+
+using namespace std;
+
+static int g_repeat = 5;
+static const char *g_filter = nullptr;
+static const char *g_map_path = "/tmp/tree_bench.map";
+
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static bool selected(const char *name)
+{
+    return !g_filter || strstr(name, g_filter) != nullptr;
+}
+
+/**
+ * @brief 输出一个用例的结果: 多次重复取中位数与最小值
+ *
+ * @param name 用例名
+ * @param param 规模参数
+ * @param ops 每次重复的操作数
+ * @param samples 每次重复的耗时(ns)
+ */
+static void report(const char *name, long param, uint64_t ops, vector<uint64_t> &samples)
+{
+    sort(samples.begin(), samples.end());
+    uint64_t median = samples[samples.size() / 2];
+    uint64_t best = samples[0];
+    printf("{\"bench\":\"%s\",\"param\":%ld,\"ops\":%llu,\"repeat\":%zu,"
+           "\"median_ns_per_op\":%.2f,\"min_ns_per_op\":%.2f,\"ops_per_sec\":%.0f}\n",
+           name, param, (unsigned long long)ops, samples.size(),
+           (double)median / ops, (double)best / ops, ops * 1e9 / median);
+    fflush(stdout);
+}
+
+//防止查找结果被优化掉
+static volatile long g_sink;
+
+enum KEY_ORDER
+{
+    SORTED = 0,
+    REVERSE,
+    RANDOM
+};
+
+static const char *order_name[] = {"sorted", "reverse", "random"};
+
+static vector<int> make_keys(int n, KEY_ORDER order)
+{
+    vector<int> keys(n);
+    for (int i = 0; i < n; ++i)
+    {
+        keys[i] = i;
+    }
+    if (order == REVERSE)
+    {
+        reverse(keys.begin(), keys.end());
+    }
+    else if (order == RANDOM)
+    {
+        shuffle(keys.begin(), keys.end(), mt19937(12345));
+    }
+    return keys;
+}
+
+/*************************** 不做平衡的二叉搜索树 ***************************/
+
+//平衡之前BTnode::insert_val的做法: 只按<下降，有序输入退化为链表
+struct naive_node
+{
+    int val;
+    int cnt;
+    naive_node *lchild;
+    naive_node *rchild;
+};
+
+static void naive_insert(naive_node *&root, int val)
+{
+    naive_node **link = &root;
+    while (*link)
+    {
+        naive_node *node = *link;
+        if (val == node->val)
+        {
+            node->cnt++;
+            return;
+        }
+        link = val < node->val ? &node->lchild : &node->rchild;
+    }
+    *link = new naive_node{val, 1, nullptr, nullptr};
+}
+
+static int naive_count(const naive_node *node, int val)
+{
+    while (node)
+    {
+        if (val == node->val)
+        {
+            return node->cnt;
+        }
+        node = val < node->val ? node->lchild : node->rchild;
+    }
+    return 0;
+}
+
+static void naive_destroy(naive_node *root)
+{
+    vector<naive_node *> stack;
+    if (root)
+    {
+        stack.push_back(root);
+    }
+    while (!stack.empty())
+    {
+        naive_node *node = stack.back();
+        stack.pop_back();
+        if (node->lchild)
+        {
+            stack.push_back(node->lchild);
+        }
+        if (node->rchild)
+        {
+            stack.push_back(node->rchild);
+        }
+        delete node;
+    }
+}
+
+/*************************** insert/find ***************************/
+
+template <typename Tree, typename Insert, typename Count>
+static void bench_tree(const char *impl, int n, KEY_ORDER order, Insert insert, Count count)
+{
+    vector<int> keys = make_keys(n, order);
+    vector<int> probes = make_keys(n, RANDOM);
+    char name[64];
+
+    vector<uint64_t> ins, find, scan, clear;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        Tree tree = Tree();
+        uint64_t t0 = now_ns();
+        for (int i = 0; i < n; ++i)
+        {
+            insert(tree, keys[i]);
+        }
+        uint64_t t1 = now_ns();
+        long hits = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            hits += count(tree, probes[i]);
+        }
+        uint64_t t2 = now_ns();
+        for (int i = 0; i < n; ++i)
+        {
+            hits += count(tree, i);
+        }
+        uint64_t t3 = now_ns();
+        g_sink = hits;
+        tree.release();
+        uint64_t t4 = now_ns();
+        ins.push_back(t1 - t0);
+        find.push_back(t2 - t1);
+        scan.push_back(t3 - t2);
+        clear.push_back(t4 - t3);
+    }
+    snprintf(name, sizeof(name), "%s_insert_%s", impl, order_name[order]);
+    report(name, n, n, ins);
+    snprintf(name, sizeof(name), "%s_find_%s", impl, order_name[order]);
+    report(name, n, n, find);
+    snprintf(name, sizeof(name), "%s_scan_%s", impl, order_name[order]);
+    report(name, n, n, scan);
+    snprintf(name, sizeof(name), "%s_clear_%s", impl, order_name[order]);
+    report(name, n, n, clear);
+}
+
+//各实现的统一外壳，release释放整棵树
+template <typename Alloc>
+struct avl_tree
+{
+    BinaryTree<int, Alloc> *tree;
+    avl_tree() : tree(new BinaryTree<int, Alloc>) {}
+    void release() { delete tree; }
+};
+
+typedef avl_tree<BTnodePool<BTnode<int> > > avl_pool_tree;
+typedef avl_tree<BTnodeNew<BTnode<int> > > avl_new_tree;
+
+struct naive_tree
+{
+    naive_node *root;
+    naive_tree() : root(nullptr) {}
+    void release() { naive_destroy(root); }
+};
+
+struct std_tree
+{
+    multiset<int> *tree;
+    std_tree() : tree(new multiset<int>) {}
+    void release() { delete tree; }
+};
+
+static void bench_insert_find(int n, int naive_n)
+{
+    for (int o = SORTED; o <= RANDOM; ++o)
+    {
+        KEY_ORDER order = (KEY_ORDER)o;
+        if (selected("avl_pool"))
+        {
+            bench_tree<avl_pool_tree>("avl_pool", n, order, [](avl_pool_tree &t, int k) { t.tree->insert(k); },
+                                      [](avl_pool_tree &t, int k) { return t.tree->count(k); });
+        }
+        if (selected("avl_new"))
+        {
+            bench_tree<avl_new_tree>("avl_new", n, order, [](avl_new_tree &t, int k) { t.tree->insert(k); },
+                                     [](avl_new_tree &t, int k) { return t.tree->count(k); });
+        }
+        if (selected("std"))
+        {
+            bench_tree<std_tree>("std", n, order, [](std_tree &t, int k) { t.tree->insert(k); },
+                                 [](std_tree &t, int k) { return (int)t.tree->count(k); });
+        }
+        //有序输入时为O(n^2)，规模单独指定
+        if (selected("naive"))
+        {
+            bench_tree<naive_tree>("naive", naive_n, order, [](naive_tree &t, int k) { naive_insert(t.root, k); },
+                                   [](naive_tree &t, int k) { return naive_count(t.root, k); });
+        }
+    }
+}
+
+/*************************** bulk ***************************/
+
+static void bench_bulk(int n)
+{
+    mt19937 rng(4242);
+    vector<int> random_keys;
+    for (int i = 0; i < n; ++i)
+    {
+        random_keys.push_back(rng() % n);
+    }
+    vector<int> sorted_keys = random_keys;
+    sort(sorted_keys.begin(), sorted_keys.end());
+
+    const vector<int> *inputs[] = {&sorted_keys, &random_keys};
+    const char *input_name[] = {"sorted", "random"};
+    char name[64];
+    for (int i = 0; i < 2; ++i)
+    {
+        const vector<int> &keys = *inputs[i];
+        vector<uint64_t> bulk, single;
+        for (int r = 0; r < g_repeat; ++r)
+        {
+            uint64_t t0 = now_ns();
+            BinaryTree<int> *loaded = new BinaryTree<int>(keys.begin(), keys.end());
+            uint64_t t1 = now_ns();
+            BinaryTree<int> *inserted = new BinaryTree<int>;
+            for (size_t k = 0; k < keys.size(); ++k)
+            {
+                inserted->insert(keys[k]);
+            }
+            uint64_t t2 = now_ns();
+            g_sink = loaded->height() + inserted->height();
+            bulk.push_back(t1 - t0);
+            single.push_back(t2 - t1);
+            delete loaded;
+            delete inserted;
+        }
+        snprintf(name, sizeof(name), "bulk_load_%s", input_name[i]);
+        report(name, n, n, bulk);
+        snprintf(name, sizeof(name), "bulk_insert_%s", input_name[i]);
+        report(name, n, n, single);
+    }
+}
+
+/*************************** iter ***************************/
+
+template <typename Tree>
+static void bench_iter(const char *impl, int n)
+{
+    vector<int> keys = make_keys(n, RANDOM);
+    Tree tree(keys.begin(), keys.end());
+    char name[64];
+
+    vector<uint64_t> walk, copy;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        long sum = 0;
+        uint64_t t0 = now_ns();
+        for (typename Tree::const_iterator it = tree.begin(); it != tree.end(); ++it)
+        {
+            sum += *it;
+        }
+        uint64_t t1 = now_ns();
+        Tree *dup = new Tree(tree);
+        uint64_t t2 = now_ns();
+        g_sink = sum + dup->size();
+        delete dup;
+        walk.push_back(t1 - t0);
+        copy.push_back(t2 - t1);
+    }
+    snprintf(name, sizeof(name), "iter_%s_walk", impl);
+    report(name, n, n, walk);
+    snprintf(name, sizeof(name), "iter_%s_copy", impl);
+    report(name, n, n, copy);
+}
+
+/**
+ * @brief 对同一组随机探测键重复查询，计时并输出
+ *
+ * @param query 返回一次查询的结果(命中个数或找到的值)，累加到g_sink防止被优化掉
+ */
+template <typename Query>
+static void bench_query(const char *name, int n, const vector<int> &probes, Query query)
+{
+    vector<uint64_t> samples;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        long sum = 0;
+        uint64_t t0 = now_ns();
+        for (size_t i = 0; i < probes.size(); ++i)
+        {
+            sum += query(probes[i]);
+        }
+        samples.push_back(now_ns() - t0);
+        g_sink = sum;
+    }
+    report(name, n, probes.size(), samples);
+}
+
+/*************************** rank ***************************/
+
+static void bench_rank(int n)
+{
+    vector<int> keys = make_keys(n, RANDOM);
+    vector<int> probes;
+    mt19937 rng(31);
+    for (int i = 0; i < n; ++i)
+    {
+        probes.push_back(rng() % n);
+    }
+
+    //插入时维护子树大小的开销
+    vector<uint64_t> plain, ranked;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        BinaryTree<int> *a = new BinaryTree<int>;
+        RankedTree<int> *b = new RankedTree<int>;
+        uint64_t t0 = now_ns();
+        for (int i = 0; i < n; ++i)
+        {
+            a->insert(keys[i]);
+        }
+        uint64_t t1 = now_ns();
+        for (int i = 0; i < n; ++i)
+        {
+            b->insert(keys[i]);
+        }
+        uint64_t t2 = now_ns();
+        plain.push_back(t1 - t0);
+        ranked.push_back(t2 - t1);
+        delete a;
+        delete b;
+    }
+    report("rank_insert_plain", n, n, plain);
+    report("rank_insert_ranked", n, n, ranked);
+
+    RankedTree<int> tree(keys.begin(), keys.end());
+    bench_query("rank_rank", n, probes, [&](int k) { return (long)tree.rank(k); });
+    bench_query("rank_select", n, probes, [&](int k) { return *tree.select(k); });
+    bench_query("rank_count_range", n, probes, [&](int k) { return (long)tree.count_range(k / 2, k); });
+
+    //没有子树大小时只能沿中序数到第k个
+    vector<int> few(probes.begin(), probes.begin() + min<size_t>(probes.size(), 200));
+    bench_query("rank_select_scan", n, few, [&](int k) {
+        RankedTree<int>::const_iterator it = tree.begin();
+        advance(it, k);
+        return *it;
+    });
+}
+
+/*************************** frozen ***************************/
+
+static void bench_frozen(int n)
+{
+    //键为偶数，探测键一半命中一半不命中
+    vector<int> keys = make_keys(n, RANDOM);
+    BinaryTree<int> tree;
+    for (int i = 0; i < n; ++i)
+    {
+        tree.insert(keys[i] * 2);
+    }
+    vector<int> probes;
+    mt19937 rng(777);
+    for (int i = 0; i < n; ++i)
+    {
+        probes.push_back(rng() % (2 * n));
+    }
+
+    vector<uint64_t> build;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        uint64_t t0 = now_ns();
+        FrozenTree<int> frozen(tree);
+        build.push_back(now_ns() - t0);
+        g_sink = frozen.size();
+    }
+    report("frozen_build", n, n, build);
+
+    FrozenTree<int> frozen(tree);
+    bench_query("frozen_tree_find", n, probes, [&](int k) { return tree.count(k); });
+    bench_query("frozen_find", n, probes, [&](int k) { return frozen.count(k); });
+    bench_query("frozen_tree_lower_bound", n, probes, [&](int k) {
+        const int *p = tree.lower_bound(k);
+        return p ? *p : 0;
+    });
+    bench_query("frozen_lower_bound", n, probes, [&](int k) {
+        const int *p = frozen.lower_bound(k);
+        return p ? *p : 0;
+    });
+}
+
+/*************************** mapped ***************************/
+
+static void bench_mapped(int n)
+{
+    vector<int> keys = make_keys(n, RANDOM);
+    vector<int> probes;
+    mt19937 rng(55);
+    for (int i = 0; i < n; ++i)
+    {
+        probes.push_back(rng() % (2 * n));
+    }
+    char path[256];
+    snprintf(path, sizeof(path), "%s.noindex", g_map_path);
+
+    //现在的启动方式: 逐个插入重建
+    vector<uint64_t> rebuild;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        uint64_t t0 = now_ns();
+        BinaryTree<int> *tree = new BinaryTree<int>;
+        for (int i = 0; i < n; ++i)
+        {
+            tree->insert(keys[i] * 2);
+        }
+        rebuild.push_back(now_ns() - t0);
+        delete tree;
+    }
+    report("mapped_rebuild_insert", n, n, rebuild);
+
+    BinaryTree<int> tree;
+    for (int i = 0; i < n; ++i)
+    {
+        tree.insert(keys[i] * 2);
+    }
+    vector<uint64_t> save;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        uint64_t t0 = now_ns();
+        if (!MappedTree<int>::save(tree, g_map_path) || !MappedTree<int>::save(tree, path, false))
+        {
+            fprintf(stderr, "save %s failed\n", g_map_path);
+            return;
+        }
+        save.push_back(now_ns() - t0);
+    }
+    report("mapped_save", n, n, save);
+
+    //打开并完成第一次查询，即启动到可用的时间
+    vector<uint64_t> open_first;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        uint64_t t0 = now_ns();
+        MappedTree<int> mapped;
+        mapped.open(g_map_path);
+        g_sink = mapped.count(probes[r]);
+        open_first.push_back(now_ns() - t0);
+    }
+    report("mapped_open_first_query", n, 1, open_first);
+
+    MappedTree<int> indexed, plain;
+    indexed.open(g_map_path);
+    plain.open(path);
+    bench_query("mapped_tree_find", n, probes, [&](int k) { return tree.count(k); });
+    bench_query("mapped_find_index", n, probes, [&](int k) { return indexed.count(k); });
+    bench_query("mapped_find_noindex", n, probes, [&](int k) { return plain.count(k); });
+
+    vector<uint64_t> convert;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        BinaryTree<int> *back = new BinaryTree<int>;
+        uint64_t t0 = now_ns();
+        indexed.to_tree(*back);
+        convert.push_back(now_ns() - t0);
+        delete back;
+    }
+    report("mapped_to_tree", n, n, convert);
+    unlink(path);
+}
+
+/*************************** concurrent ***************************/
+
+//加读写锁的BinaryTree，作为对比
+struct locked_tree
+{
+    BinaryTree<int> tree;
+    pthread_rwlock_t lock;
+    locked_tree() { pthread_rwlock_init(&lock, NULL); }
+    ~locked_tree() { pthread_rwlock_destroy(&lock); }
+    int count(int k)
+    {
+        pthread_rwlock_rdlock(&lock);
+        int c = tree.count(k);
+        pthread_rwlock_unlock(&lock);
+        return c;
+    }
+    void insert(int k)
+    {
+        pthread_rwlock_wrlock(&lock);
+        tree.insert(k);
+        pthread_rwlock_unlock(&lock);
+    }
+    void remove(int k)
+    {
+        pthread_rwlock_wrlock(&lock);
+        tree.remove(k);
+        pthread_rwlock_unlock(&lock);
+    }
+};
+
+/**
+ * @brief readers个读线程与一个写线程同时运行duration_ms毫秒，输出读与写的吞吐
+ *
+ * 树中预先放入n个偶数键，写线程插入并删除奇数键，读线程查找[0, 2n)中的随机键
+ */
+template <typename Tree>
+static void bench_rw(const char *impl, Tree &tree, int n, int readers, int duration_ms)
+{
+    atomic<bool> stop(false);
+    atomic<long> reads(0);
+    long writes = 0;
+    vector<thread> threads;
+    for (int r = 0; r < readers; ++r)
+    {
+        threads.push_back(thread([&, r]() {
+            mt19937 rng(r + 1);
+            long done = 0, hits = 0;
+            while (!stop.load(memory_order_relaxed))
+            {
+                for (int i = 0; i < 256; ++i)
+                {
+                    hits += tree.count(rng() % (2 * n));
+                }
+                done += 256;
+            }
+            reads += done;
+            g_sink = hits;
+        }));
+    }
+    thread writer([&]() {
+        mt19937 rng(999);
+        while (!stop.load(memory_order_relaxed))
+        {
+            int k = (rng() % n) * 2 + 1;
+            tree.insert(k);
+            tree.remove(k);
+            writes += 2;
+        }
+    });
+    uint64_t t0 = now_ns();
+    usleep(duration_ms * 1000);
+    stop = true;
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        threads[i].join();
+    }
+    writer.join();
+    double secs = (now_ns() - t0) / 1e9;
+    printf("{\"bench\":\"concurrent_%s\",\"param\":%d,\"readers\":%d,"
+           "\"reads_per_sec\":%.0f,\"writes_per_sec\":%.0f}\n",
+           impl, n, readers, reads.load() / secs, writes / secs);
+    fflush(stdout);
+}
+
+static void bench_concurrent(int n, int max_threads, int duration_ms)
+{
+    vector<int> keys = make_keys(n, RANDOM);
+    ConcurrentTree<int> ctree;
+    locked_tree ltree;
+    for (int i = 0; i < n; ++i)
+    {
+        ctree.insert(keys[i] * 2);
+        ltree.insert(keys[i] * 2);
+    }
+    for (int readers = 1; readers <= max_threads; readers *= 2)
+    {
+        bench_rw("cow", ctree, n, readers, duration_ms);
+        bench_rw("rwlock", ltree, n, readers, duration_ms);
+    }
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-b filter] [-r repeat] [-n keys] [-m naive_keys] [-t max_readers] [-d duration_ms] [-f map_file]\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+    int n = 1000000;
+    int naive_n = 20000;
+    int max_threads = max(1u, thread::hardware_concurrency());
+    int duration_ms = 1000;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:r:n:m:t:d:f:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            g_filter = optarg;
+            break;
+        case 'r':
+            g_repeat = max(1, atoi(optarg));
+            break;
+        case 'n':
+            n = atoi(optarg);
+            break;
+        case 'm':
+            naive_n = atoi(optarg);
+            break;
+        case 't':
+            max_threads = max(1, atoi(optarg));
+            break;
+        case 'd':
+            duration_ms = max(1, atoi(optarg));
+            break;
+        case 'f':
+            g_map_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    bench_insert_find(n, naive_n);
+    if (selected("bulk"))
+    {
+        bench_bulk(n);
+    }
+    if (selected("iter"))
+    {
+        bench_iter<BinaryTree<int> >("avl", n);
+        bench_iter<multiset<int> >("std", n);
+    }
+    if (selected("rank"))
+    {
+        bench_rank(n);
+    }
+    if (selected("frozen"))
+    {
+        bench_frozen(n);
+    }
+    if (selected("mapped"))
+    {
+        bench_mapped(n);
+    }
+    if (selected("concurrent"))
+    {
+        bench_concurrent(n, max_threads, duration_ms);
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file BTnodePool.hpp
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief BinaryTree 的结点分配策略
+            ===============
+            BinaryTree的第二个模板参数，负责结点内存的申请与归还，结点的构造与析构仍由树完成.
+            > * BTnodePool: 默认策略，从连续的块中按顺序切出结点，删除的结点挂到空闲链表上复用，release一次归还所有块
+            > * BTnodeNew: 每个结点单独operator new/delete，与平衡前的做法相同
+            > * 自定义策略需提供node_type、allocate/deallocate/release以及常量owns_all，owns_all为true表示release会归还全部结点，clear时无需逐个归还
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __BTNODEPOOL_HPP__
+#define __BTNODEPOOL_HPP__
+#include <cstddef>
+#include <new>
+#include <vector>
+
+template <typename nodeType>
+class BTnodePool
+{
+public:
+    typedef nodeType node_type;
+    static const bool owns_all = true;
+
+    BTnodePool() : _free(nullptr), _next(nullptr), _end(nullptr), _block_nodes(min_block) {}
+    ~BTnodePool() { release(); }
+
+    //每棵树独占一个池，复制树时新树从空池开始
+    BTnodePool(const BTnodePool &) : _free(nullptr), _next(nullptr), _end(nullptr), _block_nodes(min_block) {}
+    BTnodePool &operator=(const BTnodePool &) { return *this; }
+
+    nodeType *allocate();
+    void deallocate(nodeType *node);
+    //归还所有块，之前分配的结点全部失效，不调用析构函数
+    void release();
+
+    size_t blocks() const { return _blocks.size(); }
+
+private:
+    //空闲的结点复用其内存保存链表指针
+    union slot
+    {
+        slot *next;
+        alignas(nodeType) char storage[sizeof(nodeType)];
+    };
+
+    //块的大小从min_block个结点起倍增，到max_block为止
+    static const size_t min_block = 64;
+    static const size_t max_block = 16384;
+
+    slot *_free;              //空闲链表
+    slot *_next;              //当前块中下一个未用过的结点
+    slot *_end;               //当前块的末尾
+    size_t _block_nodes;      //下一个块的结点数
+    std::vector<slot *> _blocks;
+};
+
+template <typename nodeType>
+inline nodeType *BTnodePool<nodeType>::allocate()
+{
+    if (_free)
+    {
+        slot *s = _free;
+        _free = s->next;
+        return reinterpret_cast<nodeType *>(s);
+    }
+    if (_next == _end)
+    {
+        _next = static_cast<slot *>(::operator new(_block_nodes * sizeof(slot)));
+        _end = _next + _block_nodes;
+        _blocks.push_back(_next);
+        if (_block_nodes < max_block)
+        {
+            _block_nodes *= 2;
+        }
+    }
+    return reinterpret_cast<nodeType *>(_next++);
+}
+
+template <typename nodeType>
+inline void BTnodePool<nodeType>::deallocate(nodeType *node)
+{
+    slot *s = reinterpret_cast<slot *>(node);
+    s->next = _free;
+    _free = s;
+}
+
+template <typename nodeType>
+void BTnodePool<nodeType>::release()
+{
+    for (size_t i = 0; i < _blocks.size(); ++i)
+    {
+        ::operator delete(_blocks[i]);
+    }
+    _blocks.clear();
+    _free = _next = _end = nullptr;
+    _block_nodes = min_block;
+}
+
+/*****************************************/
+template <typename nodeType>
+class BTnodeNew
+{
+public:
+    typedef nodeType node_type;
+    static const bool owns_all = false;
+
+    nodeType *allocate() { return static_cast<nodeType *>(::operator new(sizeof(nodeType))); }
+    void deallocate(nodeType *node) { ::operator delete(node); }
+    void release() {}
+};
+
+#endif /* __BTNODEPOOL_HPP__ */
@@ -1,7 +1,17 @@
 /**
  * @file BinaryTree.hpp
  * @author caogh (caoguanghuaplus@163.com)
- * @brief
+ * @brief 二叉搜索树
+            ===============
+            以AVL树实现，插入、删除与查找在任何输入顺序下都是O(log n).
+            > * 相同的值只保存一个结点，结点的_cnt记录重复次数
+            > * remove删除一个值的全部重复
+            > * 元素类型只需支持operator<，a与b等价当且仅当!(a < b) && !(b < a)
+            > * 第二个模板参数为结点分配策略(见BTnodePool.hpp)，默认从块中分配结点，clear时整块归还
+            > * 由区间构造或bulk_load时先排序(已有序则跳过)，再自底向上建成完全平衡的树，O(n)
+            > * 结点保存父指针，插入、删除、复制、销毁与中序遍历都不递归，除路径外不占额外空间
+            > * const_iterator为中序的双向迭代器，每个不同的值访问一次，支持范围for与标准算法
+            > * RankedTree的结点另记子树中的元素个数，支持O(log n)的rank/select/count_range，普通BinaryTree不付出这部分开销
  * @version 0.1
  * @date 2021-12-22
  *
@@ -10,47 +20,973 @@
  */
 #ifndef __BINARYTREE_HPP__
 #define __BINARYTREE_HPP__
-template <typename Type>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <initializer_list>
+#include "BTnodePool.hpp"
+
+template <typename valType, bool ranked = false>
+class BTnode;
+
+template <typename elemType, typename Alloc = BTnodePool<BTnode<elemType> > >
 class BinaryTree;
 
-template <typename valType>
-class BTnode
+template <typename elemType>
+class FrozenTree;
+
+/**
+ * @brief 结点可选的子树大小，ranked为false时为空基类，不占空间
+ *
+ */
+template <bool ranked>
+class BTrank
+{
+public:
+    size_t total() const { return 0; }
+    void set_total(size_t) {}
+};
+
+template <>
+class BTrank<true>
+{
+public:
+    //以本结点为根的子树中的元素个数，重复的元素分别计数
+    size_t total() const { return _total; }
+    void set_total(size_t total) { _total = total; }
+
+private:
+    size_t _total;
+};
+
+template <typename valType, bool ranked>
+class BTnode : public BTrank<ranked>
 {
 public:
     BTnode(const valType &val);
 
+    static const bool is_ranked = ranked;
+
 public:
+    template <typename elemType, typename Alloc>
     friend class BinaryTree;
+    template <typename elemType>
+    friend class FrozenTree;
+
+    const valType &value() const { return _val; }
+    int count() const { return _cnt; }
 
 private:
-    void insert_val(const valType &);
-    void remove_value(const valType &, BTnode *&);
+    //root为树的根指针，插入或删除后沿父指针向上重新平衡
+    template <typename Alloc>
+    static void insert_val(const valType &, BTnode *&root, Alloc &alloc);
+    template <typename Alloc>
+    static int remove_value(const valType &, BTnode *&root, Alloc &alloc);
+
+    //结点的内存由分配策略提供，构造与析构在这里完成
+    template <typename Alloc>
+    static BTnode *create(const valType &val, Alloc &alloc);
+    template <typename Alloc>
+    void dispose(Alloc &alloc);
+
+    static int height(const BTnode *node) { return node ? node->_height : 0; }
+    static size_t subtree(const BTnode *node) { return node ? node->total() : 0; }
+    //由孩子重新计算高度与子树大小
+    void update();
+    //_cnt或子树的结构变了，从node起向上重新计算子树大小，ranked为false时什么也不做
+    static void recount(BTnode *node);
+    //旋转与平衡的参数为指向子树根的链接(父结点的孩子指针或根指针)，完成后它指向新的子树根
+    static void rotate_left(BTnode *&node);
+    static void rotate_right(BTnode *&node);
+    static void rebalance(BTnode *&node);
+    //指向node的链接，node为根时是树的根指针
+    static BTnode *&link(BTnode *node, BTnode *&root);
+    //从node起逐层向上重新平衡，子树高度不再变化时停止
+    static void retrace(BTnode *node, BTnode *&root);
+
+    //中序遍历
+    static const BTnode *leftmost(const BTnode *node);
+    static const BTnode *rightmost(const BTnode *node);
+    static const BTnode *next(const BTnode *node);
+    static const BTnode *prev(const BTnode *node);
 
 private:
     valType _val;
     int _cnt;
+    int _height; //以本结点为根的子树高度，叶子为1
     BTnode *_lchild;
     BTnode *_rchild;
+    BTnode *_parent;
 };
 
-template <typename elemType>
+template <typename elemType, typename Alloc>
 class BinaryTree
 {
 public:
+    //结点类型由分配策略决定，RankedTree的结点记录子树大小
+    typedef typename Alloc::node_type node_type;
+
     BinaryTree();
+    template <typename Iter>
+    BinaryTree(Iter first, Iter last);
+    BinaryTree(std::initializer_list<elemType> elems);
     BinaryTree(const BinaryTree &);
     ~BinaryTree();
     BinaryTree &operator=(const BinaryTree &);
 
+    /**
+     * @brief 中序的双向迭代器，每个不同的值访问一次，重复次数由count()给出
+     *
+     */
+    class const_iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef elemType value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const elemType *pointer;
+        typedef const elemType &reference;
+
+        const_iterator() : _node(nullptr), _root(nullptr) {}
+
+        reference operator*() const { return _node->_val; }
+        pointer operator->() const { return &_node->_val; }
+        int count() const { return _node->_cnt; }
+
+        const_iterator &operator++()
+        {
+            _node = node_type::next(_node);
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        //end()向前移动到最大的元素
+        const_iterator &operator--()
+        {
+            _node = _node ? node_type::prev(_node) : node_type::rightmost(*_root);
+            return *this;
+        }
+        const_iterator operator--(int)
+        {
+            const_iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator &rhs) const { return _node == rhs._node; }
+        bool operator!=(const const_iterator &rhs) const { return _node != rhs._node; }
+
+    private:
+        friend class BinaryTree;
+        const_iterator(const node_type *node, node_type *const *root) : _node(node), _root(root) {}
+
+        const node_type *_node; //end()为nullptr
+        node_type *const *_root;
+    };
+    //元素决定结点的位置，不允许通过迭代器修改
+    typedef const_iterator iterator;
+
+    const_iterator begin() const { return const_iterator(node_type::leftmost(_root), &_root); }
+    const_iterator end() const { return const_iterator(nullptr, &_root); }
+
     bool empty() const { return _root == nullptr; }
+    //元素个数，重复的元素分别计数
+    size_t size() const { return _size; }
+    int height() const { return node_type::height(_root); }
     void clear();
 
     void insert(const elemType &elem);
+    //用[first, last)替换树中原有的元素
+    template <typename Iter>
+    void bulk_load(Iter first, Iter last);
+    //用n个严格递增的值替换树中原有的元素，cnts[i]为vals[i]的重复次数
+    void bulk_load_counted(const elemType *vals, const int *cnts, size_t n);
+    //删除elem的全部重复，返回删除的个数
+    int remove(const elemType &elem);
+
+    //返回树中与elem等价的元素，不存在时返回nullptr
+    const elemType *find(const elemType &elem) const;
+    int count(const elemType &elem) const;
+    //第一个不小于elem的元素，不存在时返回nullptr
+    const elemType *lower_bound(const elemType &elem) const;
+    //第一个大于elem的元素，不存在时返回nullptr
+    const elemType *upper_bound(const elemType &elem) const;
+
+    //以下只用于RankedTree，均为O(log n)
+    //小于elem的元素个数，重复的元素分别计数
+    size_t rank(const elemType &elem) const;
+    //从0起第k小的元素，k >= size()时返回nullptr
+    const elemType *select(size_t k) const;
+    //落在[lo, hi)中的元素个数
+    size_t count_range(const elemType &lo, const elemType &hi) const;
 
 private:
-    BTnode<elemType> *_root;
+    template <typename valType>
+    friend class FrozenTree;
 
-    void copy(BinaryTree<elemType> *tar, BinaryTree<elemType> *src);
+    const node_type *find_node(const elemType &elem) const;
+    node_type *clone(const node_type *src, node_type *parent);
+    node_type *copy(const node_type *src);
+    node_type *build(const elemType *vals, const int *cnts, size_t lo, size_t hi);
+    static void sort_elems(std::vector<elemType> &elems);
+    void destroy(node_type *node);
+
+private:
+    node_type *_root;
+    size_t _size;
+    Alloc _alloc;
 };
 
-#endif /* __BINARYTREE_HPP__ */
\ No newline at end of file
+//结点记录子树大小的BinaryTree
+template <typename elemType>
+using RankedTree = BinaryTree<elemType, BTnodePool<BTnode<elemType, true> > >;
+
+/*****************************************/
+template <typename valType, bool ranked>
+inline BTnode<valType, ranked>::BTnode(const valType &val) : _val(val)
+{
+    _cnt = 1;
+    _height = 1;
+    _lchild = _rchild = _parent = nullptr;
+    this->set_total(1);
+}
+
+template <typename valType, bool ranked>
+template <typename Alloc>
+inline BTnode<valType, ranked> *BTnode<valType, ranked>::create(const valType &val, Alloc &alloc)
+{
+    BTnode *node = alloc.allocate();
+    try
+    {
+        return new (node) BTnode(val);
+    }
+    catch (...)
+    {
+        alloc.deallocate(node);
+        throw;
+    }
+}
+
+template <typename valType, bool ranked>
+template <typename Alloc>
+inline void BTnode<valType, ranked>::dispose(Alloc &alloc)
+{
+    this->~BTnode();
+    alloc.deallocate(this);
+}
+
+template <typename valType, bool ranked>
+inline void BTnode<valType, ranked>::update()
+{
+    int lh = height(_lchild);
+    int rh = height(_rchild);
+    _height = (lh > rh ? lh : rh) + 1;
+    this->set_total(_cnt + subtree(_lchild) + subtree(_rchild));
+}
+
+template <typename valType, bool ranked>
+inline void BTnode<valType, ranked>::recount(BTnode *node)
+{
+    if (!ranked)
+    {
+        return;
+    }
+    for (; node; node = node->_parent)
+    {
+        node->set_total(node->_cnt + subtree(node->_lchild) + subtree(node->_rchild));
+    }
+}
+
+/**
+ * @brief 左旋: 右孩子成为子树的根
+ *
+ */
+template <typename valType, bool ranked>
+inline void BTnode<valType, ranked>::rotate_left(BTnode *&node)
+{
+    BTnode *top = node;
+    BTnode *r = top->_rchild;
+    top->_rchild = r->_lchild;
+    if (r->_lchild)
+    {
+        r->_lchild->_parent = top;
+    }
+    r->_lchild = top;
+    r->_parent = top->_parent;
+    top->_parent = r;
+    top->update();
+    r->update();
+    node = r;
+}
+
+template <typename valType, bool ranked>
+inline void BTnode<valType, ranked>::rotate_right(BTnode *&node)
+{
+    BTnode *top = node;
+    BTnode *l = top->_lchild;
+    top->_lchild = l->_rchild;
+    if (l->_rchild)
+    {
+        l->_rchild->_parent = top;
+    }
+    l->_rchild = top;
+    l->_parent = top->_parent;
+    top->_parent = l;
+    top->update();
+    l->update();
+    node = l;
+}
+
+/**
+ * @brief 左右子树高度差超过1时旋转，先把"之"字形的孙子转到外侧
+ *
+ */
+template <typename valType, bool ranked>
+void BTnode<valType, ranked>::rebalance(BTnode *&node)
+{
+    int balance = height(node->_lchild) - height(node->_rchild);
+    if (balance > 1)
+    {
+        if (height(node->_lchild->_lchild) < height(node->_lchild->_rchild))
+        {
+            rotate_left(node->_lchild);
+        }
+        rotate_right(node);
+    }
+    else if (balance < -1)
+    {
+        if (height(node->_rchild->_rchild) < height(node->_rchild->_lchild))
+        {
+            rotate_right(node->_rchild);
+        }
+        rotate_left(node);
+    }
+    else
+    {
+        node->update();
+    }
+}
+
+template <typename valType, bool ranked>
+inline BTnode<valType, ranked> *&BTnode<valType, ranked>::link(BTnode *node, BTnode *&root)
+{
+    BTnode *parent = node->_parent;
+    if (!parent)
+    {
+        return root;
+    }
+    return parent->_lchild == node ? parent->_lchild : parent->_rchild;
+}
+
+/**
+ * @brief 插入或删除只改变了node所在路径上的高度，一旦某个子树平衡后的高度与原来相同，更上层不受影响
+ *
+ */
+template <typename valType, bool ranked>
+void BTnode<valType, ranked>::retrace(BTnode *node, BTnode *&root)
+{
+    while (node)
+    {
+        int old = node->_height;
+        BTnode *&top = link(node, root);
+        rebalance(top);
+        if (top->_height == old)
+        {
+            break;
+        }
+        node = top->_parent;
+    }
+}
+
+/**
+ * @brief 插入val，相同的值只增加_cnt
+ *
+ */
+template <typename valType, bool ranked>
+template <typename Alloc>
+void BTnode<valType, ranked>::insert_val(const valType &val, BTnode *&root, Alloc &alloc)
+{
+    BTnode *parent = nullptr;
+    BTnode **pos = &root;
+    while (*pos)
+    {
+        parent = *pos;
+        if (val < parent->_val)
+        {
+            pos = &parent->_lchild;
+        }
+        else if (parent->_val < val)
+        {
+            pos = &parent->_rchild;
+        }
+        else
+        {
+            parent->_cnt++;
+            recount(parent);
+            return;
+        }
+    }
+    BTnode *node = create(val, alloc);
+    node->_parent = parent;
+    *pos = node;
+    //先更新路径上的子树大小，旋转时由孩子重新计算
+    recount(parent);
+    retrace(parent, root);
+}
+
+/**
+ * @brief 删除值为val的结点，有两个孩子时由右子树的最小结点顶替
+ *
+ * @return int 删除的元素个数(结点的_cnt)，不存在时为0
+ */
+template <typename valType, bool ranked>
+template <typename Alloc>
+int BTnode<valType, ranked>::remove_value(const valType &val, BTnode *&root, Alloc &alloc)
+{
+    BTnode *node = root;
+    while (node)
+    {
+        if (val < node->_val)
+        {
+            node = node->_lchild;
+        }
+        else if (node->_val < val)
+        {
+            node = node->_rchild;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (!node)
+    {
+        return 0;
+    }
+
+    int removed = node->_cnt;
+    BTnode *&slot = link(node, root);
+    BTnode *start; //高度可能变化的最低结点
+    if (node->_lchild && node->_rchild)
+    {
+        BTnode *succ = node->_rchild;
+        while (succ->_lchild)
+        {
+            succ = succ->_lchild;
+        }
+        if (succ->_parent == node)
+        {
+            start = succ;
+        }
+        else
+        {
+            //摘下succ，它的右子树接到原来的位置
+            start = succ->_parent;
+            start->_lchild = succ->_rchild;
+            if (succ->_rchild)
+            {
+                succ->_rchild->_parent = start;
+            }
+            succ->_rchild = node->_rchild;
+            succ->_rchild->_parent = succ;
+        }
+        succ->_lchild = node->_lchild;
+        succ->_lchild->_parent = succ;
+        succ->_parent = node->_parent;
+        succ->_height = node->_height;
+        slot = succ;
+    }
+    else
+    {
+        BTnode *child = node->_lchild ? node->_lchild : node->_rchild;
+        if (child)
+        {
+            child->_parent = node->_parent;
+        }
+        start = node->_parent;
+        slot = child;
+    }
+    node->dispose(alloc);
+    recount(start);
+    retrace(start, root);
+    return removed;
+}
+
+template <typename valType, bool ranked>
+inline const BTnode<valType, ranked> *BTnode<valType, ranked>::leftmost(const BTnode *node)
+{
+    while (node && node->_lchild)
+    {
+        node = node->_lchild;
+    }
+    return node;
+}
+
+template <typename valType, bool ranked>
+inline const BTnode<valType, ranked> *BTnode<valType, ranked>::rightmost(const BTnode *node)
+{
+    while (node && node->_rchild)
+    {
+        node = node->_rchild;
+    }
+    return node;
+}
+
+/**
+ * @brief 中序的后继: 有右子树时为右子树的最小结点，否则向上直到从左边回到父结点
+ *
+ */
+template <typename valType, bool ranked>
+inline const BTnode<valType, ranked> *BTnode<valType, ranked>::next(const BTnode *node)
+{
+    if (node->_rchild)
+    {
+        return leftmost(node->_rchild);
+    }
+    const BTnode *parent = node->_parent;
+    while (parent && node == parent->_rchild)
+    {
+        node = parent;
+        parent = parent->_parent;
+    }
+    return parent;
+}
+
+template <typename valType, bool ranked>
+inline const BTnode<valType, ranked> *BTnode<valType, ranked>::prev(const BTnode *node)
+{
+    if (node->_lchild)
+    {
+        return rightmost(node->_lchild);
+    }
+    const BTnode *parent = node->_parent;
+    while (parent && node == parent->_lchild)
+    {
+        node = parent;
+        parent = parent->_parent;
+    }
+    return parent;
+}
+
+/*****************************************/
+template <typename elemType, typename Alloc>
+inline BinaryTree<elemType, Alloc>::BinaryTree() : _root(nullptr), _size(0)
+{
+}
+
+template <typename elemType, typename Alloc>
+template <typename Iter>
+inline BinaryTree<elemType, Alloc>::BinaryTree(Iter first, Iter last) : _root(nullptr), _size(0)
+{
+    bulk_load(first, last);
+}
+
+template <typename elemType, typename Alloc>
+inline BinaryTree<elemType, Alloc>::BinaryTree(std::initializer_list<elemType> elems) : _root(nullptr), _size(0)
+{
+    bulk_load(elems.begin(), elems.end());
+}
+
+template <typename elemType, typename Alloc>
+inline BinaryTree<elemType, Alloc>::BinaryTree(const BinaryTree &rhs) : _root(nullptr), _size(rhs._size)
+{
+    _root = copy(rhs._root);
+}
+
+template <typename elemType, typename Alloc>
+inline BinaryTree<elemType, Alloc>::~BinaryTree()
+{
+    clear();
+}
+
+template <typename elemType, typename Alloc>
+inline BinaryTree<elemType, Alloc> &BinaryTree<elemType, Alloc>::operator=(const BinaryTree &rhs)
+{
+    if (this != &rhs)
+    {
+        clear();
+        _root = copy(rhs._root);
+        _size = rhs._size;
+    }
+    return *this;
+}
+
+template <typename elemType, typename Alloc>
+inline typename BinaryTree<elemType, Alloc>::node_type *BinaryTree<elemType, Alloc>::clone(const node_type *src, node_type *parent)
+{
+    node_type *node = node_type::create(src->_val, _alloc);
+    node->_cnt = src->_cnt;
+    node->_height = src->_height;
+    node->set_total(src->total());
+    node->_parent = parent;
+    return node;
+}
+
+/**
+ * @brief 按先序复制，src与新树中对应的结点一起移动，孩子已复制过的方向不再进入
+ *
+ */
+template <typename elemType, typename Alloc>
+typename BinaryTree<elemType, Alloc>::node_type *BinaryTree<elemType, Alloc>::copy(const node_type *src)
+{
+    if (!src)
+    {
+        return nullptr;
+    }
+    node_type *root = clone(src, nullptr);
+    node_type *dst = root;
+    while (dst)
+    {
+        if (src->_lchild && !dst->_lchild)
+        {
+            dst->_lchild = clone(src->_lchild, dst);
+            src = src->_lchild;
+            dst = dst->_lchild;
+        }
+        else if (src->_rchild && !dst->_rchild)
+        {
+            dst->_rchild = clone(src->_rchild, dst);
+            src = src->_rchild;
+            dst = dst->_rchild;
+        }
+        else
+        {
+            src = src->_parent;
+            dst = dst->_parent;
+        }
+    }
+    return root;
+}
+
+/**
+ * @brief 按后序销毁: 下降到叶子，销毁后从父结点摘下，再回到父结点
+ *
+ */
+template <typename elemType, typename Alloc>
+void BinaryTree<elemType, Alloc>::destroy(node_type *node)
+{
+    while (node)
+    {
+        if (node->_lchild)
+        {
+            node = node->_lchild;
+            continue;
+        }
+        if (node->_rchild)
+        {
+            node = node->_rchild;
+            continue;
+        }
+        node_type *parent = node->_parent;
+        if (parent)
+        {
+            if (parent->_lchild == node)
+            {
+                parent->_lchild = nullptr;
+            }
+            else
+            {
+                parent->_rchild = nullptr;
+            }
+        }
+        if (Alloc::owns_all)
+        {
+            node->~BTnode();
+        }
+        else
+        {
+            node->dispose(_alloc);
+        }
+        node = parent;
+    }
+}
+
+template <typename elemType, typename Alloc>
+inline void BinaryTree<elemType, Alloc>::clear()
+{
+    //池会整块归还结点，元素无需析构时不必遍历
+    if (!Alloc::owns_all || !std::is_trivially_destructible<elemType>::value)
+    {
+        destroy(_root);
+    }
+    _alloc.release();
+    _root = nullptr;
+    _size = 0;
+}
+
+template <typename elemType, typename Alloc>
+inline void BinaryTree<elemType, Alloc>::insert(const elemType &elem)
+{
+    node_type::insert_val(elem, _root, _alloc);
+    _size++;
+}
+
+/**
+ * @brief 由严格递增的值建树，取中间的值为根，左右两半递归建子树
+ *
+ * @param vals 不同的值
+ * @param cnts 每个值的重复次数
+ * @param lo 本子树包含第[lo, hi)个值
+ * @param hi
+ */
+template <typename elemType, typename Alloc>
+typename BinaryTree<elemType, Alloc>::node_type *BinaryTree<elemType, Alloc>::build(const elemType *vals, const int *cnts, size_t lo, size_t hi)
+{
+    if (lo == hi)
+    {
+        return nullptr;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    //先建左子树再分配根，结点在池中按中序排列
+    node_type *left = build(vals, cnts, lo, mid);
+    node_type *node = node_type::create(vals[mid], _alloc);
+    node->_cnt = cnts[mid];
+    node->_lchild = left;
+    node->_rchild = build(vals, cnts, mid + 1, hi);
+    if (node->_lchild)
+    {
+        node->_lchild->_parent = node;
+    }
+    if (node->_rchild)
+    {
+        node->_rchild->_parent = node;
+    }
+    node->update();
+    return node;
+}
+
+/**
+ * @brief 元素较多且有多个核时分段并行排序，再逐层归并
+ *
+ */
+template <typename elemType, typename Alloc>
+void BinaryTree<elemType, Alloc>::sort_elems(std::vector<elemType> &elems)
+{
+    const size_t parallel_min = 1 << 16;
+    size_t parts = std::thread::hardware_concurrency();
+    if (parts > 8)
+    {
+        parts = 8;
+    }
+    size_t n = elems.size();
+    if (parts < 2 || n < parallel_min)
+    {
+        std::sort(elems.begin(), elems.end());
+        return;
+    }
+
+    typename std::vector<elemType>::iterator begin = elems.begin();
+    size_t step = (n + parts - 1) / parts;
+    std::vector<std::thread> workers;
+    for (size_t lo = step; lo < n; lo += step)
+    {
+        size_t hi = std::min(lo + step, n);
+        workers.push_back(std::thread([begin, lo, hi]() { std::sort(begin + lo, begin + hi); }));
+    }
+    std::sort(begin, begin + std::min(step, n));
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i].join();
+    }
+    for (size_t width = step; width < n; width *= 2)
+    {
+        for (size_t lo = 0; lo + width < n; lo += 2 * width)
+        {
+            std::inplace_merge(begin + lo, begin + lo + width, begin + std::min(lo + 2 * width, n));
+        }
+    }
+}
+
+template <typename elemType, typename Alloc>
+template <typename Iter>
+void BinaryTree<elemType, Alloc>::bulk_load(Iter first, Iter last)
+{
+    std::vector<elemType> elems(first, last);
+    if (!std::is_sorted(elems.begin(), elems.end()))
+    {
+        sort_elems(elems);
+    }
+    //相同的值合并为一个结点，不同的值前移到elems的开头
+    size_t total = elems.size();
+    std::vector<int> cnts;
+    size_t distinct = 0;
+    for (size_t i = 0; i < total; ++i)
+    {
+        if (distinct > 0 && !(elems[distinct - 1] < elems[i]))
+        {
+            cnts[distinct - 1]++;
+            continue;
+        }
+        if (distinct != i)
+        {
+            elems[distinct] = elems[i];
+        }
+        cnts.push_back(1);
+        distinct++;
+    }
+
+    clear();
+    _root = build(elems.data(), cnts.data(), 0, distinct);
+    _size = total;
+}
+
+template <typename elemType, typename Alloc>
+void BinaryTree<elemType, Alloc>::bulk_load_counted(const elemType *vals, const int *cnts, size_t n)
+{
+    clear();
+    _root = build(vals, cnts, 0, n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        _size += cnts[i];
+    }
+}
+
+template <typename elemType, typename Alloc>
+inline int BinaryTree<elemType, Alloc>::remove(const elemType &elem)
+{
+    int removed = node_type::remove_value(elem, _root, _alloc);
+    _size -= removed;
+    return removed;
+}
+
+template <typename elemType, typename Alloc>
+const typename BinaryTree<elemType, Alloc>::node_type *BinaryTree<elemType, Alloc>::find_node(const elemType &elem) const
+{
+    const node_type *node = _root;
+    while (node)
+    {
+        if (elem < node->_val)
+        {
+            node = node->_lchild;
+        }
+        else if (node->_val < elem)
+        {
+            node = node->_rchild;
+        }
+        else
+        {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+template <typename elemType, typename Alloc>
+inline const elemType *BinaryTree<elemType, Alloc>::find(const elemType &elem) const
+{
+    const node_type *node = find_node(elem);
+    return node ? &node->_val : nullptr;
+}
+
+template <typename elemType, typename Alloc>
+inline int BinaryTree<elemType, Alloc>::count(const elemType &elem) const
+{
+    const node_type *node = find_node(elem);
+    return node ? node->_cnt : 0;
+}
+
+template <typename elemType, typename Alloc>
+const elemType *BinaryTree<elemType, Alloc>::lower_bound(const elemType &elem) const
+{
+    const node_type *node = _root;
+    const node_type *bound = nullptr;
+    while (node)
+    {
+        if (node->_val < elem)
+        {
+            node = node->_rchild;
+        }
+        else
+        {
+            bound = node;
+            node = node->_lchild;
+        }
+    }
+    return bound ? &bound->_val : nullptr;
+}
+
+template <typename elemType, typename Alloc>
+const elemType *BinaryTree<elemType, Alloc>::upper_bound(const elemType &elem) const
+{
+    const node_type *node = _root;
+    const node_type *bound = nullptr;
+    while (node)
+    {
+        if (elem < node->_val)
+        {
+            bound = node;
+            node = node->_lchild;
+        }
+        else
+        {
+            node = node->_rchild;
+        }
+    }
+    return bound ? &bound->_val : nullptr;
+}
+
+template <typename elemType, typename Alloc>
+size_t BinaryTree<elemType, Alloc>::rank(const elemType &elem) const
+{
+    static_assert(node_type::is_ranked, "rank需要结点记录子树大小，请使用RankedTree");
+    size_t less = 0;
+    const node_type *node = _root;
+    while (node)
+    {
+        if (node->_val < elem)
+        {
+            less += node_type::subtree(node->_lchild) + node->_cnt;
+            node = node->_rchild;
+        }
+        else
+        {
+            node = node->_lchild;
+        }
+    }
+    return less;
+}
+
+template <typename elemType, typename Alloc>
+const elemType *BinaryTree<elemType, Alloc>::select(size_t k) const
+{
+    static_assert(node_type::is_ranked, "select需要结点记录子树大小，请使用RankedTree");
+    const node_type *node = _root;
+    while (node)
+    {
+        size_t left = node_type::subtree(node->_lchild);
+        if (k < left)
+        {
+            node = node->_lchild;
+        }
+        else if (k < left + node->_cnt)
+        {
+            return &node->_val;
+        }
+        else
+        {
+            k -= left + node->_cnt;
+            node = node->_rchild;
+        }
+    }
+    return nullptr;
+}
+
+template <typename elemType, typename Alloc>
+inline size_t BinaryTree<elemType, Alloc>::count_range(const elemType &lo, const elemType &hi) const
+{
+    if (!(lo < hi))
+    {
+        return 0;
+    }
+    return rank(hi) - rank(lo);
+}
+
+#endif /* __BINARYTREE_HPP__ */
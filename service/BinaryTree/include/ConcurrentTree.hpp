@@ -0,0 +1,603 @@
+/**
+ * @file ConcurrentTree.hpp
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief 读多写少的并发二叉搜索树
+            ===============
+            多个线程可同时读，写操作之间串行，读不加锁、不等待写.
+            > * 结点发布后不再修改，写操作复制从根到修改点路径上的结点(及旋转涉及的结点)，最后原子地替换根指针
+            > * 读线程在读的期间占用一个读槽并记下进入时的纪元，被替换下来的结点按纪元挂起，直到没有更早进入的读者才释放
+            > * 读槽个数固定(read_slots)，同时读的线程更多时后来者自旋等待空槽
+            > * 平衡规则与BinaryTree相同(AVL)，相同的值只保存一个结点并计数
+            > * 结点只在持有写锁时分配与释放，复用BTnodePool
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __CONCURRENTTREE_HPP__
+#define __CONCURRENTTREE_HPP__
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "BTnodePool.hpp"
+
+template <typename elemType>
+class ConcurrentTree
+{
+public:
+    ConcurrentTree();
+    ~ConcurrentTree();
+
+    //元素个数，重复的元素分别计数
+    size_t size() const { return _size.load(std::memory_order_relaxed); }
+    bool empty() const { return size() == 0; }
+
+    void insert(const elemType &elem);
+    //删除elem的全部重复，返回删除的个数
+    int remove(const elemType &elem);
+    void clear();
+
+    int count(const elemType &elem) const;
+    bool contains(const elemType &elem) const { return count(elem) > 0; }
+    //结点可能在返回后被释放，查到的元素复制到out，不存在时返回false
+    bool lower_bound(const elemType &elem, elemType &out) const;
+    bool upper_bound(const elemType &elem, elemType &out) const;
+
+    //等待释放的结点数
+    size_t retired() const;
+
+private:
+    ConcurrentTree(const ConcurrentTree &);
+    ConcurrentTree &operator=(const ConcurrentTree &);
+
+    struct CTnode
+    {
+        elemType _val;
+        int _cnt;
+        int _height;
+        unsigned long _gen; //创建它的写操作的序号，等于当前序号时尚未发布，可以直接修改
+        CTnode *_lchild;
+        CTnode *_rchild;
+    };
+
+    static const int read_slots = 64;
+    static const unsigned long idle = ~0ul;
+
+    //读槽独占一个缓存行，避免读者之间伪共享
+    struct alignas(64) read_slot
+    {
+        std::atomic<unsigned long> epoch;
+    };
+
+    /**
+     * @brief 读期间占用一个读槽，析构时归还
+     *
+     */
+    class read_guard
+    {
+    public:
+        read_guard(const ConcurrentTree *tree);
+        ~read_guard() { _slot->epoch.store(idle, std::memory_order_release); }
+
+    private:
+        read_slot *_slot;
+    };
+
+    //写操作，均在持有_write_lock时调用
+    CTnode *create(const elemType &val);
+    CTnode *own(CTnode *node);
+    void retire(CTnode *node);
+    void reclaim();
+    static int height(const CTnode *node) { return node ? node->_height : 0; }
+    static void update(CTnode *node);
+    CTnode *rotate_left(CTnode *node);
+    CTnode *rotate_right(CTnode *node);
+    CTnode *rebalance(CTnode *node);
+    CTnode *insert_val(CTnode *node, const elemType &val);
+    CTnode *remove_value(CTnode *node, const elemType &val, int &removed);
+    CTnode *remove_min(CTnode *node, CTnode *&min);
+    void publish(CTnode *root);
+    void abandon();
+    void destroy(CTnode *node);
+
+private:
+    std::atomic<CTnode *> _root;
+    std::atomic<size_t> _size;
+    mutable read_slot _slots[read_slots];
+    std::atomic<unsigned long> _epoch;
+
+    mutable std::mutex _write_lock;
+    unsigned long _gen;
+    BTnodePool<CTnode> _pool;
+    std::vector<CTnode *> _pending;                              //本次写操作替换下来的结点，发布新根后才挂起
+    std::vector<std::pair<unsigned long, CTnode *> > _retired; //(被替换时的纪元, 结点)
+};
+
+template <typename elemType>
+ConcurrentTree<elemType>::ConcurrentTree() : _root(nullptr), _size(0), _epoch(1), _gen(0)
+{
+    for (int i = 0; i < read_slots; ++i)
+    {
+        _slots[i].epoch.store(idle, std::memory_order_relaxed);
+    }
+}
+
+template <typename elemType>
+ConcurrentTree<elemType>::~ConcurrentTree()
+{
+    destroy(_root.load(std::memory_order_relaxed));
+    for (size_t i = 0; i < _retired.size(); ++i)
+    {
+        _retired[i].second->~CTnode();
+    }
+}
+
+/**
+ * @brief 从本线程固定的起点找一个空闲的读槽，记下当前纪元
+ *
+ */
+template <typename elemType>
+ConcurrentTree<elemType>::read_guard::read_guard(const ConcurrentTree *tree)
+{
+    static std::atomic<unsigned> next_hint(0);
+    static thread_local unsigned hint = next_hint.fetch_add(1, std::memory_order_relaxed);
+    for (unsigned i = hint;; ++i)
+    {
+        read_slot *slot = &tree->_slots[i % read_slots];
+        unsigned long expected = idle;
+        if (slot->epoch.load(std::memory_order_relaxed) == idle &&
+            slot->epoch.compare_exchange_strong(expected, tree->_epoch.load()))
+        {
+            _slot = slot;
+            return;
+        }
+        if (i - hint >= (unsigned)read_slots)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+template <typename elemType>
+int ConcurrentTree<elemType>::count(const elemType &elem) const
+{
+    read_guard guard(this);
+    const CTnode *node = _root.load();
+    while (node)
+    {
+        if (elem < node->_val)
+        {
+            node = node->_lchild;
+        }
+        else if (node->_val < elem)
+        {
+            node = node->_rchild;
+        }
+        else
+        {
+            return node->_cnt;
+        }
+    }
+    return 0;
+}
+
+template <typename elemType>
+bool ConcurrentTree<elemType>::lower_bound(const elemType &elem, elemType &out) const
+{
+    read_guard guard(this);
+    const CTnode *node = _root.load();
+    const CTnode *bound = nullptr;
+    while (node)
+    {
+        if (node->_val < elem)
+        {
+            node = node->_rchild;
+        }
+        else
+        {
+            bound = node;
+            node = node->_lchild;
+        }
+    }
+    if (bound)
+    {
+        out = bound->_val;
+    }
+    return bound != nullptr;
+}
+
+template <typename elemType>
+bool ConcurrentTree<elemType>::upper_bound(const elemType &elem, elemType &out) const
+{
+    read_guard guard(this);
+    const CTnode *node = _root.load();
+    const CTnode *bound = nullptr;
+    while (node)
+    {
+        if (elem < node->_val)
+        {
+            bound = node;
+            node = node->_lchild;
+        }
+        else
+        {
+            node = node->_rchild;
+        }
+    }
+    if (bound)
+    {
+        out = bound->_val;
+    }
+    return bound != nullptr;
+}
+
+template <typename elemType>
+size_t ConcurrentTree<elemType>::retired() const
+{
+    std::lock_guard<std::mutex> lock(_write_lock);
+    return _retired.size();
+}
+
+/*****************************************/
+template <typename elemType>
+inline typename ConcurrentTree<elemType>::CTnode *ConcurrentTree<elemType>::create(const elemType &val)
+{
+    CTnode *node = _pool.allocate();
+    try
+    {
+        new (&node->_val) elemType(val);
+    }
+    catch (...)
+    {
+        _pool.deallocate(node);
+        throw;
+    }
+    node->_cnt = 1;
+    node->_height = 1;
+    node->_gen = _gen;
+    node->_lchild = node->_rchild = nullptr;
+    return node;
+}
+
+/**
+ * @brief 返回node的可修改版本: 本次写操作新建的结点直接返回，已发布的结点复制一份并将原结点挂起
+ *
+ */
+template <typename elemType>
+inline typename ConcurrentTree<elemType>::CTnode *ConcurrentTree<elemType>::own(CTnode *node)
+{
+    if (node->_gen == _gen)
+    {
+        return node;
+    }
+    CTnode *copy = create(node->_val);
+    copy->_cnt = node->_cnt;
+    copy->_height = node->_height;
+    copy->_lchild = node->_lchild;
+    copy->_rchild = node->_rchild;
+    retire(node);
+    return copy;
+}
+
+template <typename elemType>
+inline void ConcurrentTree<elemType>::retire(CTnode *node)
+{
+    if (node->_gen == _gen)
+    {
+        //未发布过，没有读者能看到
+        node->~CTnode();
+        _pool.deallocate(node);
+        return;
+    }
+    _pending.push_back(node);
+}
+
+/**
+ * @brief 释放所有读者都已看不到的结点: 挂起时的纪元早于所有正在读的读者进入时的纪元
+ *
+ */
+template <typename elemType>
+void ConcurrentTree<elemType>::reclaim()
+{
+    unsigned long oldest = idle;
+    for (int i = 0; i < read_slots; ++i)
+    {
+        unsigned long e = _slots[i].epoch.load();
+        if (e < oldest)
+        {
+            oldest = e;
+        }
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < _retired.size(); ++i)
+    {
+        if (_retired[i].first < oldest)
+        {
+            _retired[i].second->~CTnode();
+            _pool.deallocate(_retired[i].second);
+        }
+        else
+        {
+            _retired[kept++] = _retired[i];
+        }
+    }
+    _retired.resize(kept);
+}
+
+/**
+ * @brief 换上新根后推进纪元，之后进入的读者只能看到新树
+ *
+ */
+template <typename elemType>
+void ConcurrentTree<elemType>::publish(CTnode *root)
+{
+    _root.store(root);
+    unsigned long epoch = _epoch.fetch_add(1);
+    for (size_t i = 0; i < _pending.size(); ++i)
+    {
+        _retired.push_back(std::make_pair(epoch, _pending[i]));
+    }
+    _pending.clear();
+    ++_gen;
+    if (_retired.size() >= 64)
+    {
+        reclaim();
+    }
+}
+
+/**
+ * @brief 写操作中途抛出异常，旧树仍在使用，替换下来的结点不能挂起；已建的新结点留在池中直到析构
+ *
+ */
+template <typename elemType>
+void ConcurrentTree<elemType>::abandon()
+{
+    _pending.clear();
+    ++_gen;
+}
+
+template <typename elemType>
+inline void ConcurrentTree<elemType>::update(CTnode *node)
+{
+    int lh = height(node->_lchild);
+    int rh = height(node->_rchild);
+    node->_height = (lh > rh ? lh : rh) + 1;
+}
+
+//旋转的参数均已可修改，返回新的子树根
+template <typename elemType>
+typename ConcurrentTree<elemType>::CTnode *ConcurrentTree<elemType>::rotate_left(CTnode *node)
+{
+    CTnode *r = own(node->_rchild);
+    node->_rchild = r->_lchild;
+    r->_lchild = node;
+    update(node);
+    update(r);
+    return r;
+}
+
+template <typename elemType>
+typename ConcurrentTree<elemType>::CTnode *ConcurrentTree<elemType>::rotate_right(CTnode *node)
+{
+    CTnode *l = own(node->_lchild);
+    node->_lchild = l->_rchild;
+    l->_rchild = node;
+    update(node);
+    update(l);
+    return l;
+}
+
+template <typename elemType>
+typename ConcurrentTree<elemType>::CTnode *ConcurrentTree<elemType>::rebalance(CTnode *node)
+{
+    int balance = height(node->_lchild) - height(node->_rchild);
+    if (balance > 1)
+    {
+        if (height(node->_lchild->_lchild) < height(node->_lchild->_rchild))
+        {
+            node->_lchild = rotate_left(own(node->_lchild));
+        }
+        return rotate_right(node);
+    }
+    if (balance < -1)
+    {
+        if (height(node->_rchild->_rchild) < height(node->_rchild->_lchild))
+        {
+            node->_rchild = rotate_right(own(node->_rchild));
+        }
+        return rotate_left(node);
+    }
+    update(node);
+    return node;
+}
+
+template <typename elemType>
+typename ConcurrentTree<elemType>::CTnode *ConcurrentTree<elemType>::insert_val(CTnode *node, const elemType &val)
+{
+    if (!node)
+    {
+        return create(val);
+    }
+    node = own(node);
+    if (val < node->_val)
+    {
+        node->_lchild = insert_val(node->_lchild, val);
+    }
+    else if (node->_val < val)
+    {
+        node->_rchild = insert_val(node->_rchild, val);
+    }
+    else
+    {
+        node->_cnt++;
+        return node;
+    }
+    return rebalance(node);
+}
+
+template <typename elemType>
+typename ConcurrentTree<elemType>::CTnode *ConcurrentTree<elemType>::remove_min(CTnode *node, CTnode *&min)
+{
+    if (!node->_lchild)
+    {
+        min = node;
+        return node->_rchild;
+    }
+    node = own(node);
+    node->_lchild = remove_min(node->_lchild, min);
+    return rebalance(node);
+}
+
+/**
+ * @brief 删除val所在的结点，有两个孩子时把右子树最小结点的值搬到这里
+ *
+ */
+template <typename elemType>
+typename ConcurrentTree<elemType>::CTnode *ConcurrentTree<elemType>::remove_value(CTnode *node, const elemType &val, int &removed)
+{
+    if (!node)
+    {
+        return nullptr;
+    }
+    if (val < node->_val)
+    {
+        CTnode *left = remove_value(node->_lchild, val, removed);
+        if (!removed)
+        {
+            return node;
+        }
+        node = own(node);
+        node->_lchild = left;
+    }
+    else if (node->_val < val)
+    {
+        CTnode *right = remove_value(node->_rchild, val, removed);
+        if (!removed)
+        {
+            return node;
+        }
+        node = own(node);
+        node->_rchild = right;
+    }
+    else
+    {
+        removed = node->_cnt;
+        if (!node->_lchild || !node->_rchild)
+        {
+            CTnode *child = node->_lchild ? node->_lchild : node->_rchild;
+            retire(node);
+            return child;
+        }
+        CTnode *min = nullptr;
+        CTnode *right = remove_min(node->_rchild, min);
+        CTnode *succ = create(min->_val);
+        succ->_cnt = min->_cnt;
+        succ->_lchild = node->_lchild;
+        succ->_rchild = right;
+        retire(min);
+        retire(node);
+        node = succ;
+    }
+    return rebalance(node);
+}
+
+template <typename elemType>
+void ConcurrentTree<elemType>::insert(const elemType &elem)
+{
+    std::lock_guard<std::mutex> lock(_write_lock);
+    try
+    {
+        publish(insert_val(_root.load(std::memory_order_relaxed), elem));
+    }
+    catch (...)
+    {
+        abandon();
+        throw;
+    }
+    _size.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename elemType>
+int ConcurrentTree<elemType>::remove(const elemType &elem)
+{
+    std::lock_guard<std::mutex> lock(_write_lock);
+    int removed = 0;
+    CTnode *root;
+    try
+    {
+        root = remove_value(_root.load(std::memory_order_relaxed), elem, removed);
+    }
+    catch (...)
+    {
+        abandon();
+        throw;
+    }
+    if (removed)
+    {
+        publish(root);
+        _size.fetch_sub(removed, std::memory_order_relaxed);
+    }
+    return removed;
+}
+
+/**
+ * @brief 换上空树，旧树的结点全部挂起
+ *
+ */
+template <typename elemType>
+void ConcurrentTree<elemType>::clear()
+{
+    std::lock_guard<std::mutex> lock(_write_lock);
+    CTnode *old = _root.load(std::memory_order_relaxed);
+    std::vector<CTnode *> stack;
+    if (old)
+    {
+        stack.push_back(old);
+    }
+    while (!stack.empty())
+    {
+        CTnode *node = stack.back();
+        stack.pop_back();
+        if (node->_lchild)
+        {
+            stack.push_back(node->_lchild);
+        }
+        if (node->_rchild)
+        {
+            stack.push_back(node->_rchild);
+        }
+        retire(node);
+    }
+    publish(nullptr);
+    _size.store(0, std::memory_order_relaxed);
+}
+
+//析构时已没有读者，只需析构元素，内存随池一起归还
+template <typename elemType>
+void ConcurrentTree<elemType>::destroy(CTnode *node)
+{
+    std::vector<CTnode *> stack;
+    if (node)
+    {
+        stack.push_back(node);
+    }
+    while (!stack.empty())
+    {
+        node = stack.back();
+        stack.pop_back();
+        if (node->_lchild)
+        {
+            stack.push_back(node->_lchild);
+        }
+        if (node->_rchild)
+        {
+            stack.push_back(node->_rchild);
+        }
+        node->~CTnode();
+    }
+}
+
+#endif /* __CONCURRENTTREE_HPP__ */
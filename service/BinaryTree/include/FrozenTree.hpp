@@ -0,0 +1,156 @@
+/**
+ * @file FrozenTree.hpp
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief BinaryTree 的只读快照
+            ===============
+            由BinaryTree构造，之后不再修改，适合一次建好、大量查询的场景.
+            > * 键按Eytzinger(层序)顺序存放在一个按缓存行对齐的数组中，结点k的孩子为2k与2k+1，下降时不再追指针
+            > * 查找循环中没有分支，比较结果直接算出下一个下标，命中时才访问计数数组
+            > * 每一步预取若干层之后的后代，一个缓存行容纳的后代恰好连续存放
+            > * 查询接口与BinaryTree相同: find/count/lower_bound/upper_bound
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __FROZENTREE_HPP__
+#define __FROZENTREE_HPP__
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include "BinaryTree.hpp"
+
+template <typename elemType>
+class FrozenTree
+{
+public:
+    template <typename Alloc>
+    explicit FrozenTree(const BinaryTree<elemType, Alloc> &tree);
+    ~FrozenTree();
+
+    bool empty() const { return _nodes == 0; }
+    //元素个数，重复的元素分别计数
+    size_t size() const { return _size; }
+    //不同的值的个数
+    size_t nodes() const { return _nodes; }
+
+    //返回与elem等价的元素，不存在时返回nullptr
+    const elemType *find(const elemType &elem) const;
+    int count(const elemType &elem) const;
+    //第一个不小于elem的元素，不存在时返回nullptr
+    const elemType *lower_bound(const elemType &elem) const;
+    //第一个大于elem的元素，不存在时返回nullptr
+    const elemType *upper_bound(const elemType &elem) const;
+
+private:
+    FrozenTree(const FrozenTree &);
+    FrozenTree &operator=(const FrozenTree &);
+
+    //一个缓存行能放下的键数，每步预取log2(per_line)层之后的第一个后代
+    static const size_t line = 64;
+    static const size_t per_line = sizeof(elemType) >= line ? 1 : line / sizeof(elemType);
+
+    //按中序把结点填入层序下标k的子树，返回下一个待填的中序位置
+    size_t fill(const std::vector<std::pair<const elemType *, int> > &sorted, size_t i, size_t k);
+    //k为下降结束时的下标，去掉末尾连续的1(向右走的步)再去掉一个0，得到最后一次向左走的结点
+    static size_t last_left(size_t k) { return k >> (__builtin_ctzl(~k) + 1); }
+    void prefetch(size_t k) const { __builtin_prefetch(_keys + k * per_line); }
+
+private:
+    elemType *_keys; //下标从1开始，_keys[0]不使用
+    int *_cnts;
+    size_t _nodes;
+    size_t _size;
+};
+
+template <typename elemType>
+template <typename Alloc>
+FrozenTree<elemType>::FrozenTree(const BinaryTree<elemType, Alloc> &tree) : _keys(nullptr), _cnts(nullptr), _nodes(0), _size(tree.size())
+{
+    //中序遍历得到按序排列的值与重复次数
+    typedef typename BinaryTree<elemType, Alloc>::node_type node_type;
+    std::vector<std::pair<const elemType *, int> > sorted;
+    for (const node_type *node = node_type::leftmost(tree._root); node; node = node_type::next(node))
+    {
+        sorted.push_back(std::make_pair(&node->_val, node->_cnt));
+    }
+
+    _nodes = sorted.size();
+    void *mem = nullptr;
+    if (posix_memalign(&mem, line, (_nodes + 1) * sizeof(elemType)) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    _keys = static_cast<elemType *>(mem);
+    _cnts = new int[_nodes + 1];
+    _cnts[0] = 0;
+    fill(sorted, 0, 1);
+}
+
+template <typename elemType>
+size_t FrozenTree<elemType>::fill(const std::vector<std::pair<const elemType *, int> > &sorted, size_t i, size_t k)
+{
+    if (k <= _nodes)
+    {
+        i = fill(sorted, i, 2 * k);
+        new (_keys + k) elemType(*sorted[i].first);
+        _cnts[k] = sorted[i].second;
+        i = fill(sorted, i + 1, 2 * k + 1);
+    }
+    return i;
+}
+
+template <typename elemType>
+FrozenTree<elemType>::~FrozenTree()
+{
+    for (size_t k = 1; k <= _nodes; ++k)
+    {
+        _keys[k].~elemType();
+    }
+    free(_keys);
+    delete[] _cnts;
+}
+
+template <typename elemType>
+inline const elemType *FrozenTree<elemType>::lower_bound(const elemType &elem) const
+{
+    size_t k = 1;
+    while (k <= _nodes)
+    {
+        prefetch(k);
+        k = 2 * k + (_keys[k] < elem);
+    }
+    k = last_left(k);
+    return k ? _keys + k : nullptr;
+}
+
+template <typename elemType>
+inline const elemType *FrozenTree<elemType>::upper_bound(const elemType &elem) const
+{
+    size_t k = 1;
+    while (k <= _nodes)
+    {
+        prefetch(k);
+        k = 2 * k + !(elem < _keys[k]);
+    }
+    k = last_left(k);
+    return k ? _keys + k : nullptr;
+}
+
+template <typename elemType>
+inline const elemType *FrozenTree<elemType>::find(const elemType &elem) const
+{
+    const elemType *bound = lower_bound(elem);
+    return bound && !(elem < *bound) ? bound : nullptr;
+}
+
+template <typename elemType>
+inline int FrozenTree<elemType>::count(const elemType &elem) const
+{
+    const elemType *bound = find(elem);
+    return bound ? _cnts[bound - _keys] : 0;
+}
+
+#endif /* __FROZENTREE_HPP__ */
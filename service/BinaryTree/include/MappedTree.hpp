@@ -0,0 +1,360 @@
+/**
+ * @file MappedTree.hpp
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief BinaryTree 的持久化文件
+            ===============
+            把树保存为可直接mmap的文件，打开后无需反序列化即可查询，只有访问到的页才会读入内存.
+            > * 只支持可按位复制的元素类型，文件只在字节序与结构布局相同的机器之间通用
+            > * 文件布局: 文件头 | 升序的键 | 每个键的重复次数(int32) | 可选的查找索引
+            > * 查找索引为按Eytzinger(层序)排列的键及其重复次数，查询方式同FrozenTree，只访问索引；没有索引时在升序数组上二分
+            > * 各段按缓存行对齐；写临时文件后rename，读者始终看到完整的文件
+            > * open时检查各段都在文件范围内、重复次数均为正且总和等于元素个数，拒绝截断或损坏的文件
+            > * to_tree按需转换回可修改的BinaryTree，O(n)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __MAPPEDTREE_HPP__
+#define __MAPPEDTREE_HPP__
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include "BinaryTree.hpp"
+
+static const char MAPPEDTREE_MAGIC[8] = {'B', 'T', 'M', 'A', 'P', '0', '1', '\0'};
+
+struct mapped_tree_header
+{
+    char magic[8];
+    uint32_t elem_size;
+    uint32_t elem_align;
+    uint64_t nodes;     //不同的值的个数
+    uint64_t size;      //元素个数，重复的元素分别计数
+    uint64_t keys_off;  //升序的键
+    uint64_t cnts_off;  //重复次数
+    uint64_t index_off; //Eytzinger顺序的键，下标从1开始，没有索引时为0
+    uint64_t icnts_off; //索引中每个键的重复次数
+    uint64_t file_size;
+};
+
+template <typename elemType>
+class MappedTree
+{
+public:
+    MappedTree() : _base(nullptr), _map_size(0), _keys(nullptr), _cnts(nullptr), _index(nullptr), _icnts(nullptr), _nodes(0), _size(0) {}
+    ~MappedTree() { close(); }
+
+    /**
+     * @brief 将tree写入path
+     *
+     * @param tree
+     * @param path
+     * @param with_index 是否生成查找索引，索引另占键与重复次数各一份的空间
+     * @return false 写文件失败，原文件不受影响
+     */
+    template <typename Alloc>
+    static bool save(const BinaryTree<elemType, Alloc> &tree, const char *path, bool with_index = true);
+
+    /**
+     * @brief 映射文件
+     *
+     * @param path
+     * @return false 文件不存在或格式不对
+     */
+    bool open(const char *path);
+    void close();
+
+    bool empty() const { return _nodes == 0; }
+    size_t size() const { return _size; }
+    size_t nodes() const { return _nodes; }
+    bool indexed() const { return _index != nullptr; }
+
+    //返回的指针指向映射的文件，close后失效；有索引时指向索引中的键
+    const elemType *find(const elemType &elem) const;
+    int count(const elemType &elem) const;
+    const elemType *lower_bound(const elemType &elem) const;
+    const elemType *upper_bound(const elemType &elem) const;
+
+    //升序的第i个不同的值及其重复次数
+    const elemType &key_at(size_t i) const { return _keys[i]; }
+    int count_at(size_t i) const { return _cnts[i]; }
+
+    //转换回可修改的树，原有内容被替换
+    template <typename Alloc>
+    void to_tree(BinaryTree<elemType, Alloc> &tree) const { tree.bulk_load_counted(_keys, _cnts, _nodes); }
+
+private:
+    static_assert(std::is_trivially_copyable<elemType>::value, "MappedTree只支持可按位复制的元素类型");
+
+    MappedTree(const MappedTree &);
+    MappedTree &operator=(const MappedTree &);
+
+    static const size_t line = 64;
+    static const size_t per_line = sizeof(elemType) >= line ? 1 : line / sizeof(elemType);
+
+    static uint64_t align_up(uint64_t off) { return (off + line - 1) / line * line; }
+    static void fill(const std::vector<elemType> &keys, const std::vector<int32_t> &cnts, std::vector<elemType> &index, std::vector<int32_t> &icnts, size_t &i, size_t k);
+    static bool write_at(FILE *fp, uint64_t off, const void *data, size_t len);
+    //[off, off + count * elem)是否落在limit之内，先比较off再做除法，不会溢出
+    static bool fits(uint64_t off, uint64_t count, size_t elem, uint64_t limit) { return off <= limit && count <= (limit - off) / elem; }
+    static bool valid_counts(const int32_t *cnts, size_t n, uint64_t size);
+    static size_t last_left(size_t k) { return k >> (__builtin_ctzl(~k) + 1); }
+    //在索引上下降，返回第一个使less为false的键在索引中的下标，不存在时返回0
+    template <typename Less>
+    size_t descend(Less less) const;
+    //升序数组中的查找结果，没有索引时使用
+    const elemType *sorted_at(const elemType *key) const { return key < _keys + _nodes ? key : nullptr; }
+
+private:
+    char *_base;
+    size_t _map_size;
+    const elemType *_keys;
+    const int32_t *_cnts;
+    const elemType *_index;
+    const int32_t *_icnts;
+    size_t _nodes;
+    size_t _size;
+};
+
+template <typename elemType>
+void MappedTree<elemType>::fill(const std::vector<elemType> &keys, const std::vector<int32_t> &cnts, std::vector<elemType> &index, std::vector<int32_t> &icnts, size_t &i, size_t k)
+{
+    if (k < index.size())
+    {
+        fill(keys, cnts, index, icnts, i, 2 * k);
+        index[k] = keys[i];
+        icnts[k] = cnts[i++];
+        fill(keys, cnts, index, icnts, i, 2 * k + 1);
+    }
+}
+
+template <typename elemType>
+bool MappedTree<elemType>::write_at(FILE *fp, uint64_t off, const void *data, size_t len)
+{
+    static const char zeros[line] = {0};
+    long cur = ftell(fp);
+    if (cur < 0 || (uint64_t)cur > off || fwrite(zeros, 1, off - cur, fp) != off - cur)
+    {
+        return false;
+    }
+    return len == 0 || fwrite(data, 1, len, fp) == len;
+}
+
+template <typename elemType>
+template <typename Alloc>
+bool MappedTree<elemType>::save(const BinaryTree<elemType, Alloc> &tree, const char *path, bool with_index)
+{
+    std::vector<elemType> keys;
+    std::vector<int32_t> cnts;
+    for (typename BinaryTree<elemType, Alloc>::const_iterator it = tree.begin(); it != tree.end(); ++it)
+    {
+        keys.push_back(*it);
+        cnts.push_back(it.count());
+    }
+    uint64_t n = keys.size();
+    with_index = with_index && n > 0;
+
+    mapped_tree_header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MAPPEDTREE_MAGIC, sizeof(h.magic));
+    h.elem_size = sizeof(elemType);
+    h.elem_align = alignof(elemType);
+    h.nodes = n;
+    h.size = tree.size();
+    h.keys_off = align_up(sizeof(h));
+    h.cnts_off = align_up(h.keys_off + n * sizeof(elemType));
+    h.file_size = h.cnts_off + n * sizeof(int32_t);
+    std::vector<elemType> index;
+    std::vector<int32_t> icnts;
+    if (with_index)
+    {
+        index.resize(n + 1);
+        icnts.resize(n + 1);
+        size_t i = 0;
+        fill(keys, cnts, index, icnts, i, 1);
+        h.index_off = align_up(h.file_size);
+        h.icnts_off = align_up(h.index_off + (n + 1) * sizeof(elemType));
+        h.file_size = h.icnts_off + (n + 1) * sizeof(int32_t);
+    }
+
+    std::string tmp = std::string(path) + ".tmp";
+    FILE *fp = fopen(tmp.c_str(), "wb");
+    if (!fp)
+    {
+        return false;
+    }
+    bool ok = write_at(fp, 0, &h, sizeof(h));
+    ok = ok && write_at(fp, h.keys_off, keys.data(), n * sizeof(elemType));
+    ok = ok && write_at(fp, h.cnts_off, cnts.data(), n * sizeof(int32_t));
+    if (with_index)
+    {
+        ok = ok && write_at(fp, h.index_off, index.data(), (n + 1) * sizeof(elemType));
+        ok = ok && write_at(fp, h.icnts_off, icnts.data(), (n + 1) * sizeof(int32_t));
+    }
+    ok = fflush(fp) == 0 && ok;
+    ok = fsync(fileno(fp)) == 0 && ok;
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(tmp.c_str(), path) < 0)
+    {
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+//每个重复次数都须为正，且总和等于文件头中的元素个数
+template <typename elemType>
+bool MappedTree<elemType>::valid_counts(const int32_t *cnts, size_t n, uint64_t size)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (cnts[i] <= 0)
+        {
+            return false;
+        }
+        sum += cnts[i];
+    }
+    return sum == size;
+}
+
+template <typename elemType>
+bool MappedTree<elemType>::open(const char *path)
+{
+    close();
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(mapped_tree_header))
+    {
+        ::close(fd);
+        return false;
+    }
+    void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        return false;
+    }
+
+    //文件头中的偏移与个数都不可信，各段先按偏移与文件大小比较再算长度，接近2^64的值不会回绕通过检查
+    const mapped_tree_header *h = (const mapped_tree_header *)addr;
+    const char *base = (const char *)addr;
+    uint64_t n = h->nodes;
+    bool valid = memcmp(h->magic, MAPPEDTREE_MAGIC, sizeof(h->magic)) == 0 &&
+                 h->elem_size == sizeof(elemType) && h->elem_align == alignof(elemType) &&
+                 h->file_size == (uint64_t)st.st_size && n < h->file_size &&
+                 h->keys_off % line == 0 && h->cnts_off % line == 0 &&
+                 h->keys_off >= sizeof(mapped_tree_header) &&
+                 fits(h->keys_off, n, sizeof(elemType), h->cnts_off) &&
+                 fits(h->cnts_off, n, sizeof(int32_t), h->file_size) &&
+                 valid_counts((const int32_t *)(base + h->cnts_off), n, h->size);
+    if (valid && h->index_off)
+    {
+        valid = h->index_off % line == 0 && h->icnts_off % line == 0 &&
+                h->index_off >= sizeof(mapped_tree_header) &&
+                fits(h->index_off, n + 1, sizeof(elemType), h->icnts_off) &&
+                fits(h->icnts_off, n + 1, sizeof(int32_t), h->file_size) &&
+                valid_counts((const int32_t *)(base + h->icnts_off) + 1, n, h->size);
+    }
+    if (!valid)
+    {
+        munmap(addr, st.st_size);
+        return false;
+    }
+    _base = (char *)addr;
+    _map_size = st.st_size;
+    _keys = (const elemType *)(_base + h->keys_off);
+    _cnts = (const int32_t *)(_base + h->cnts_off);
+    _index = h->index_off ? (const elemType *)(_base + h->index_off) : nullptr;
+    _icnts = h->index_off ? (const int32_t *)(_base + h->icnts_off) : nullptr;
+    _nodes = n;
+    _size = h->size;
+    return true;
+}
+
+template <typename elemType>
+void MappedTree<elemType>::close()
+{
+    if (_base)
+    {
+        munmap(_base, _map_size);
+        _base = nullptr;
+    }
+    _map_size = 0;
+    _keys = _index = nullptr;
+    _cnts = _icnts = nullptr;
+    _nodes = _size = 0;
+}
+
+/**
+ * @brief less(key)为true时向右走，结束后最后一次向左走的结点即第一个使less为false的键
+ *
+ */
+template <typename elemType>
+template <typename Less>
+inline size_t MappedTree<elemType>::descend(Less less) const
+{
+    size_t k = 1;
+    while (k <= _nodes)
+    {
+        __builtin_prefetch(_index + k * per_line);
+        k = 2 * k + less(_index[k]);
+    }
+    return last_left(k);
+}
+
+template <typename elemType>
+const elemType *MappedTree<elemType>::lower_bound(const elemType &elem) const
+{
+    if (_index)
+    {
+        size_t k = descend([&elem](const elemType &key) { return key < elem; });
+        return k ? _index + k : nullptr;
+    }
+    return sorted_at(std::lower_bound(_keys, _keys + _nodes, elem));
+}
+
+template <typename elemType>
+const elemType *MappedTree<elemType>::upper_bound(const elemType &elem) const
+{
+    if (_index)
+    {
+        size_t k = descend([&elem](const elemType &key) { return !(elem < key); });
+        return k ? _index + k : nullptr;
+    }
+    return sorted_at(std::upper_bound(_keys, _keys + _nodes, elem));
+}
+
+template <typename elemType>
+inline const elemType *MappedTree<elemType>::find(const elemType &elem) const
+{
+    const elemType *bound = lower_bound(elem);
+    return bound && !(elem < *bound) ? bound : nullptr;
+}
+
+template <typename elemType>
+inline int MappedTree<elemType>::count(const elemType &elem) const
+{
+    const elemType *bound = find(elem);
+    if (!bound)
+    {
+        return 0;
+    }
+    return _index ? _icnts[bound - _index] : _cnts[bound - _keys];
+}
+
+#endif /* __MAPPEDTREE_HPP__ */
@@ -0,0 +1,350 @@
+/**
+ * @file catalog_bench.cpp
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief Catalog 微基准
+            ===============
+            每个用例输出一行 JSON，便于多次运行对比.
+            编译: g++ -O2 -std=c++11 -I../include catalog_bench.cpp -o catalog_bench
+            > * 数据: n个条目，60%为Book、40%为AudioBook，作者n/20个，朗读者n/100个，标题由三个词加编号组成
+            > * build: Catalog逐个add与重建索引，对比每个条目new一个Book/AudioBook放入vector<LibMat *>
+            > * memory: 两种表示各自占用的堆内存(mallinfo2的差值)，对象图另计按标题、作者建的std::multimap
+            > * author/title/prefix: 随机作者、完整标题、4字节与12字节标题前缀的查找，对比对象图上的multimap与逐个扫描
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <malloc.h>
+#include <vector>
+#include <map>
+#include <string>
+#include <random>
+#include <algorithm>
+
+#include "Catalog.hpp"
+
+using namespace std;
+
+static int g_repeat = 5;
+static const char *g_filter = nullptr;
+
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static bool selected(const char *name)
+{
+    return !g_filter || strstr(name, g_filter) != nullptr;
+}
+
+static size_t heap_used()
+{
+    return mallinfo2().uordblks;
+}
+
+/**
+ * @brief 输出一个用例的结果: 多次重复取中位数与最小值
+ *
+ * @param name 用例名
+ * @param param 规模参数
+ * @param ops 每次重复的操作数
+ * @param samples 每次重复的耗时(ns)
+ */
+static void report(const char *name, long param, uint64_t ops, vector<uint64_t> &samples)
+{
+    sort(samples.begin(), samples.end());
+    uint64_t median = samples[samples.size() / 2];
+    uint64_t best = samples[0];
+    printf("{\"bench\":\"%s\",\"param\":%ld,\"ops\":%llu,\"repeat\":%zu,"
+           "\"median_ns_per_op\":%.2f,\"min_ns_per_op\":%.2f,\"ops_per_sec\":%.0f}\n",
+           name, param, (unsigned long long)ops, samples.size(),
+           (double)median / ops, (double)best / ops, ops * 1e9 / median);
+    fflush(stdout);
+}
+
+static void report_memory(const char *name, long param, size_t bytes)
+{
+    printf("{\"bench\":\"%s\",\"param\":%ld,\"bytes\":%zu,\"bytes_per_item\":%.1f}\n",
+           name, param, bytes, (double)bytes / param);
+    fflush(stdout);
+}
+
+//防止查找结果被优化掉
+static volatile size_t g_sink;
+
+struct item
+{
+    MatKind kind;
+    string title;
+    string author;
+    string narrator;
+};
+
+static vector<item> make_items(size_t n)
+{
+    static const char *syllables[] = {"an", "bel", "cor", "dra", "el", "fan", "gor", "hal", "is", "jun",
+                                      "ka", "lor", "mi", "nor", "os", "pel", "qua", "ren", "sa", "tor"};
+    mt19937 rng(12345);
+    auto word = [&rng](size_t parts) {
+        string w;
+        for (size_t i = 0; i < parts; ++i)
+        {
+            w += syllables[rng() % 20];
+        }
+        return w;
+    };
+    size_t authors = max<size_t>(1, n / 20), narrators = max<size_t>(1, n / 100);
+    vector<string> author_names, narrator_names;
+    for (size_t i = 0; i < authors; ++i)
+    {
+        author_names.push_back(word(2) + " " + word(3) + " " + to_string(i));
+    }
+    for (size_t i = 0; i < narrators; ++i)
+    {
+        narrator_names.push_back(word(2) + " " + word(2) + " " + to_string(i));
+    }
+
+    vector<item> items(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        items[i].kind = rng() % 5 < 3 ? MAT_BOOK : MAT_AUDIOBOOK;
+        items[i].title = word(3) + " " + word(2) + " " + word(3) + " " + to_string(rng() % n);
+        items[i].author = author_names[rng() % authors];
+        if (items[i].kind == MAT_AUDIOBOOK)
+        {
+            items[i].narrator = narrator_names[rng() % narrators];
+        }
+    }
+    return items;
+}
+
+static LibMat *make_mat(const item &it)
+{
+    if (it.kind == MAT_AUDIOBOOK)
+    {
+        return new AudioBook(it.title, it.author, it.narrator);
+    }
+    return new Book(it.title, it.author);
+}
+
+static void destroy_graph(vector<LibMat *> &graph)
+{
+    for (size_t i = 0; i < graph.size(); ++i)
+    {
+        delete graph[i];
+    }
+    vector<LibMat *>().swap(graph);
+}
+
+static void bench_build(const vector<item> &items)
+{
+    long n = items.size();
+    vector<uint64_t> cat_samples, graph_samples;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        uint64_t t0 = now_ns();
+        Catalog catalog;
+        catalog.reserve(n);
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            catalog.add(items[i].kind, items[i].title, items[i].author, items[i].narrator);
+        }
+        catalog.reindex();
+        cat_samples.push_back(now_ns() - t0);
+
+        t0 = now_ns();
+        vector<LibMat *> graph;
+        graph.reserve(n);
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            graph.push_back(make_mat(items[i]));
+        }
+        graph_samples.push_back(now_ns() - t0);
+        destroy_graph(graph);
+    }
+    if (selected("build_catalog"))
+    {
+        report("build_catalog", n, n, cat_samples);
+    }
+    if (selected("build_graph"))
+    {
+        report("build_graph", n, n, graph_samples);
+    }
+}
+
+/**
+ * @brief 对象图上的索引: 按标题、按作者的multimap，值为对象指针
+ *
+ */
+struct graph_index
+{
+    multimap<string, Book *> by_title;
+    multimap<string, Book *> by_author;
+
+    explicit graph_index(const vector<LibMat *> &graph)
+    {
+        for (size_t i = 0; i < graph.size(); ++i)
+        {
+            Book *book = static_cast<Book *>(graph[i]);
+            by_title.insert(make_pair(book->title(), book));
+            by_author.insert(make_pair(book->author(), book));
+        }
+    }
+
+    size_t prefix_count(const string &prefix) const
+    {
+        size_t cnt = 0;
+        for (auto it = by_title.lower_bound(prefix); it != by_title.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+        {
+            ++cnt;
+        }
+        return cnt;
+    }
+};
+
+template <typename Fn>
+static void run_queries(const char *name, long param, const vector<string> &queries, size_t ops, Fn fn)
+{
+    if (!selected(name))
+    {
+        return;
+    }
+    vector<uint64_t> samples;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        size_t sum = 0;
+        uint64_t t0 = now_ns();
+        for (size_t i = 0; i < ops; ++i)
+        {
+            sum += fn(queries[i % queries.size()]);
+        }
+        samples.push_back(now_ns() - t0);
+        g_sink = sum;
+    }
+    report(name, param, ops, samples);
+}
+
+static void bench_queries(const vector<item> &items, size_t ops, size_t scan_ops)
+{
+    long n = items.size();
+
+    size_t base = heap_used();
+    Catalog catalog;
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        catalog.add(items[i].kind, items[i].title, items[i].author, items[i].narrator);
+    }
+    catalog.reindex();
+    size_t cat_bytes = heap_used() - base;
+
+    base = heap_used();
+    vector<LibMat *> graph;
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        graph.push_back(make_mat(items[i]));
+    }
+    size_t graph_bytes = heap_used() - base;
+    base = heap_used();
+    graph_index index(graph);
+    size_t index_bytes = heap_used() - base;
+
+    if (selected("memory"))
+    {
+        report_memory("memory_catalog", n, cat_bytes);
+        report_memory("memory_graph", n, graph_bytes);
+        report_memory("memory_graph_indexed", n, graph_bytes + index_bytes);
+    }
+
+    mt19937 rng(777);
+    vector<string> authors, titles, prefix4, prefix12;
+    for (size_t i = 0; i < 4096; ++i)
+    {
+        const item &it = items[rng() % items.size()];
+        authors.push_back(it.author);
+        titles.push_back(it.title);
+        prefix4.push_back(it.title.substr(0, 4));
+        prefix12.push_back(it.title.substr(0, 12));
+    }
+
+    run_queries("author_catalog", n, authors, ops, [&catalog](const string &q) { return catalog.by_author(q).size(); });
+    run_queries("author_graph_map", n, authors, ops, [&index](const string &q) { return index.by_author.count(q); });
+    run_queries("author_graph_scan", n, authors, scan_ops, [&graph](const string &q) {
+        size_t cnt = 0;
+        for (size_t i = 0; i < graph.size(); ++i)
+        {
+            cnt += static_cast<const Book *>(graph[i])->author() == q;
+        }
+        return cnt;
+    });
+    run_queries("title_catalog", n, titles, ops, [&catalog](const string &q) { return catalog.by_title(q).size(); });
+    run_queries("title_graph_map", n, titles, ops, [&index](const string &q) { return index.by_title.count(q); });
+    run_queries("prefix4_catalog", n, prefix4, ops, [&catalog](const string &q) { return catalog.by_title_prefix(q).size(); });
+    run_queries("prefix4_graph_map", n, prefix4, scan_ops, [&index](const string &q) { return index.prefix_count(q); });
+    run_queries("prefix12_catalog", n, prefix12, ops, [&catalog](const string &q) { return catalog.by_title_prefix(q).size(); });
+    run_queries("prefix12_graph_map", n, prefix12, ops, [&index](const string &q) { return index.prefix_count(q); });
+
+    destroy_graph(graph);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-b filter] [-r repeat] [-n items] [-q queries] [-s scan_queries]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    long n = 1000000;
+    long ops = 1000000;
+    long scan_ops = 20;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:r:n:q:s:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            g_filter = optarg;
+            break;
+        case 'r':
+            g_repeat = atoi(optarg);
+            break;
+        case 'n':
+            n = atol(optarg);
+            break;
+        case 'q':
+            ops = atol(optarg);
+            break;
+        case 's':
+            scan_ops = atol(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (g_repeat < 1 || n < 1 || ops < 1 || scan_ops < 1)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    //以-DLIBMAT_TRACE编译时对象的构造与析构会打印跟踪信息，置坏std::cout让这些输出直接丢弃
+    std::cout.setstate(std::ios::badbit);
+
+    vector<item> items = make_items(n);
+    if (selected("build"))
+    {
+        bench_build(items);
+    }
+    bench_queries(items, ops, scan_ops);
+    return 0;
+}
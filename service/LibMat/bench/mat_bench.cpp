@@ -0,0 +1,311 @@
+/**
+ * @file mat_bench.cpp
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief LibMat 对象批量处理的微基准
+            ===============
+            每个用例输出一行 JSON，便于多次运行对比.
+            编译: g++ -O2 -std=c++11 -I../include mat_bench.cpp -o mat_bench
+            打开跟踪信息对比: g++ -O2 -std=c++11 -DLIBMAT_TRACE -I../include mat_bench.cpp -o mat_bench_trace，用例名带_trace后缀
+            > * 数据: n个条目，60%为Book、40%为AudioBook，std::cout重定向到/dev/null
+            > * build/destroy: 每个对象单独new放入vector<LibMat *>，与MatCollection按值存放对比
+            > * print: 逐个虚调用print，与MatCollection::print对比
+            > * scan: 累加标题、作者(与朗读者)的长度，vector<LibMat *>上用dynamic_cast区分类型，MatCollection用for_each
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <random>
+#include <algorithm>
+
+#include "MatCollection.hpp"
+
+using namespace std;
+
+#ifdef LIBMAT_TRACE
+static const char *g_suffix = "_trace";
+#else
+static const char *g_suffix = "";
+#endif
+
+static int g_repeat = 5;
+static const char *g_filter = nullptr;
+
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static bool selected(const char *name)
+{
+    return !g_filter || strstr(name, g_filter) != nullptr;
+}
+
+/**
+ * @brief 输出一个用例的结果: 多次重复取中位数与最小值
+ *
+ * @param name 用例名，自动加上g_suffix
+ * @param param 规模参数
+ * @param ops 每次重复的操作数
+ * @param samples 每次重复的耗时(ns)
+ */
+static void report(const char *name, long param, uint64_t ops, vector<uint64_t> &samples)
+{
+    sort(samples.begin(), samples.end());
+    uint64_t median = samples[samples.size() / 2];
+    uint64_t best = samples[0];
+    printf("{\"bench\":\"%s%s\",\"param\":%ld,\"ops\":%llu,\"repeat\":%zu,"
+           "\"median_ns_per_op\":%.2f,\"min_ns_per_op\":%.2f,\"ops_per_sec\":%.0f}\n",
+           name, g_suffix, param, (unsigned long long)ops, samples.size(),
+           (double)median / ops, (double)best / ops, ops * 1e9 / median);
+    fflush(stdout);
+}
+
+//防止结果被优化掉
+static volatile size_t g_sink;
+
+struct item
+{
+    bool audio;
+    string title;
+    string author;
+    string narrator;
+};
+
+static vector<item> make_items(size_t n)
+{
+    mt19937 rng(12345);
+    vector<item> items(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        items[i].audio = rng() % 5 >= 3;
+        items[i].title = "title of material number " + to_string(rng() % n);
+        items[i].author = "author " + to_string(rng() % (n / 20 + 1));
+        if (items[i].audio)
+        {
+            items[i].narrator = "narrator " + to_string(rng() % (n / 100 + 1));
+        }
+    }
+    return items;
+}
+
+static void build_graph(const vector<item> &items, vector<LibMat *> &graph)
+{
+    graph.reserve(items.size());
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        const item &it = items[i];
+        graph.push_back(it.audio ? new AudioBook(it.title, it.author, it.narrator) : new Book(it.title, it.author));
+    }
+}
+
+static void destroy_graph(vector<LibMat *> &graph)
+{
+    for (size_t i = 0; i < graph.size(); ++i)
+    {
+        delete graph[i];
+    }
+    vector<LibMat *>().swap(graph);
+}
+
+static void build_collection(const vector<item> &items, MatCollection &mats)
+{
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        const item &it = items[i];
+        if (it.audio)
+        {
+            mats.add(AudioBook(it.title, it.author, it.narrator));
+        }
+        else
+        {
+            mats.add(Book(it.title, it.author));
+        }
+    }
+}
+
+//for_each的visitor，按具体类型重载
+struct length_sum
+{
+    size_t sum;
+
+    length_sum() : sum(0) {}
+    void operator()(const Book &book) { sum += book.title().size() + book.author().size(); }
+    void operator()(const AudioBook &book) { sum += book.title().size() + book.author().size() + book.narrator().size(); }
+};
+
+static size_t scan_graph(const vector<LibMat *> &graph)
+{
+    size_t sum = 0;
+    for (size_t i = 0; i < graph.size(); ++i)
+    {
+        const Book *book = static_cast<const Book *>(graph[i]);
+        sum += book->title().size() + book->author().size();
+        if (const AudioBook *audio = dynamic_cast<const AudioBook *>(graph[i]))
+        {
+            sum += audio->narrator().size();
+        }
+    }
+    return sum;
+}
+
+static void bench_graph(const vector<item> &items, long print_n)
+{
+    long n = items.size();
+    vector<uint64_t> build, destroy, print, scan;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        vector<LibMat *> graph;
+        uint64_t t0 = now_ns();
+        build_graph(items, graph);
+        build.push_back(now_ns() - t0);
+
+        t0 = now_ns();
+        g_sink = scan_graph(graph);
+        scan.push_back(now_ns() - t0);
+
+        t0 = now_ns();
+        for (long i = 0; i < print_n; ++i)
+        {
+            graph[i]->print();
+        }
+        print.push_back(now_ns() - t0);
+
+        t0 = now_ns();
+        destroy_graph(graph);
+        destroy.push_back(now_ns() - t0);
+    }
+    if (selected("build_graph"))
+    {
+        report("build_graph", n, n, build);
+    }
+    if (selected("scan_graph"))
+    {
+        report("scan_graph", n, n, scan);
+    }
+    if (selected("print_graph"))
+    {
+        report("print_graph", n, print_n, print);
+    }
+    if (selected("destroy_graph"))
+    {
+        report("destroy_graph", n, n, destroy);
+    }
+}
+
+static void bench_collection(const vector<item> &items, long print_n)
+{
+    long n = items.size();
+    vector<uint64_t> build, destroy, print, scan;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        MatCollection *mats = new MatCollection;
+        uint64_t t0 = now_ns();
+        build_collection(items, *mats);
+        build.push_back(now_ns() - t0);
+
+        t0 = now_ns();
+        length_sum visitor;
+        mats->for_each(visitor);
+        g_sink = visitor.sum;
+        scan.push_back(now_ns() - t0);
+
+        //只打印前print_n个，与bench_graph的数量一致
+        MatCollection head;
+        for (long i = 0, b = 0, a = 0; i < print_n; ++i)
+        {
+            if (items[i].audio)
+            {
+                head.add(mats->audiobooks()[a++]);
+            }
+            else
+            {
+                head.add(mats->books()[b++]);
+            }
+        }
+        t0 = now_ns();
+        head.print();
+        print.push_back(now_ns() - t0);
+
+        t0 = now_ns();
+        delete mats;
+        destroy.push_back(now_ns() - t0);
+    }
+    if (selected("build_collection"))
+    {
+        report("build_collection", n, n, build);
+    }
+    if (selected("scan_collection"))
+    {
+        report("scan_collection", n, n, scan);
+    }
+    if (selected("print_collection"))
+    {
+        report("print_collection", n, print_n, print);
+    }
+    if (selected("destroy_collection"))
+    {
+        report("destroy_collection", n, n, destroy);
+    }
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-b filter] [-r repeat] [-n items] [-p print_items]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    long n = 1000000;
+    long print_n = 100000;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:r:n:p:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            g_filter = optarg;
+            break;
+        case 'r':
+            g_repeat = atoi(optarg);
+            break;
+        case 'n':
+            n = atol(optarg);
+            break;
+        case 'p':
+            print_n = atol(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (g_repeat < 1 || n < 1 || print_n < 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    print_n = min(print_n, n);
+
+    //print与跟踪信息都写到std::cout，实际写出但不占用终端
+    ofstream null_out("/dev/null");
+    streambuf *old = std::cout.rdbuf(null_out.rdbuf());
+
+    vector<item> items = make_items(n);
+    bench_graph(items, print_n);
+    bench_collection(items, print_n);
+    std::cout.rdbuf(old);
+    return 0;
+}
@@ -17,12 +17,16 @@ class AudioBook : public Book
 public:
     AudioBook(const std::string &title, const std::string &author, const std::string &narrator) : Book(title, author), _narrator(narrator)
     {
-        std::cout << "AudioBook::AuditBook(" << _title
-                  << ", " << _author << ", " << _narrator << ") constructor" << std::endl;
+        LIBMAT_TRACE_LOG("AudioBook::AuditBook(" << _title
+                         << ", " << _author << ", " << _narrator << ") constructor" << std::endl);
     }
+    AudioBook(const AudioBook &) = default;
+    AudioBook(AudioBook &&) = default;
+    AudioBook &operator=(const AudioBook &) = default;
+    AudioBook &operator=(AudioBook &&) = default;
     virtual ~AudioBook()
     {
-        std::cout << "AuditBook::~AuditBook() destructor!\n";
+        LIBMAT_TRACE_LOG("AuditBook::~AuditBook() destructor!\n");
     }
 
     virtual void print() const
@@ -17,11 +17,16 @@ class Book : public LibMat
 public:
     Book(const std::string &title, const std::string &author) : _title(title), _author(author)
     {
-        std::cout << "Book::Book(" << _title << ", " << _author << ") constructor\n";
+        LIBMAT_TRACE_LOG("Book::Book(" << _title << ", " << _author << ") constructor\n");
     }
+    //有虚析构函数时不会隐式生成移动操作，显式要回来，放进vector扩容时不必复制字符串
+    Book(const Book &) = default;
+    Book(Book &&) = default;
+    Book &operator=(const Book &) = default;
+    Book &operator=(Book &&) = default;
     virtual ~Book()
     {
-        std::cout << "Book::Book() destructor\n";
+        LIBMAT_TRACE_LOG("Book::Book() destructor\n");
     }
 
     virtual void print() const
@@ -0,0 +1,301 @@
+/**
+ * @file Catalog.hpp
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief 按列存放的馆藏目录
+            ===============
+            每个条目不再是一个单独分配的对象，而是各列数组中的同一个下标，适合百万级的馆藏.
+            > * 列: 类型标签(1字节)、标题id、作者id、朗读者id(各4字节)；标题与人名分别驻留在两个StringPool中
+            > * 作者索引: 按作者id分桶的下标数组(CSR)，by_author为一次哈希查找加两次数组访问
+            > * 标题索引: 不同的标题排序后分桶，同时保存每个标题前16字节拼成的两个大端整数，不超过16字节的前缀只在整数数组上二分，更长的部分再比较字符串
+            > * 标题按C字符串处理，不应含'\0'
+            > * 索引由reindex整体重建，O(n + t log t)，t为不同标题的个数；add之后须先调用reindex再查询(查询处有assert)，批量加入后重建一次最划算
+            > * 查询是只读的，重建之后可在多个线程中同时查询；add与reindex须与查询互斥
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __CATALOG_HPP__
+#define __CATALOG_HPP__
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "AudioBook.hpp"
+#include "StringPool.hpp"
+
+//类型标签，与LibMat的各个子类对应
+enum MatKind
+{
+    MAT_LIBMAT,
+    MAT_BOOK,
+    MAT_AUDIOBOOK,
+    MAT_RENTALBOOK,
+    MAT_CDIBOOK,
+    MAT_FILMS,
+    MAT_MANZINES,
+    MAT_CHILDTOYS,
+    MAT_KINDS
+};
+
+class Catalog
+{
+public:
+    //查询结果，条目下标的连续区间，指向Catalog内部的索引，下次reindex之后失效
+    class item_range
+    {
+    public:
+        item_range() : _first(nullptr), _last(nullptr) {}
+        item_range(const uint32_t *first, const uint32_t *last) : _first(first), _last(last) {}
+
+        const uint32_t *begin() const { return _first; }
+        const uint32_t *end() const { return _last; }
+        size_t size() const { return _last - _first; }
+        bool empty() const { return _first == _last; }
+        uint32_t operator[](size_t i) const { return _first[i]; }
+
+    private:
+        const uint32_t *_first;
+        const uint32_t *_last;
+    };
+
+    Catalog() : _dirty(false) {}
+
+    //返回新条目的下标
+    uint32_t add(MatKind kind, const std::string &title, const std::string &author, const std::string &narrator = std::string());
+    uint32_t add(const Book &book) { return add(MAT_BOOK, book.title(), book.author()); }
+    uint32_t add(const AudioBook &book) { return add(MAT_AUDIOBOOK, book.title(), book.author(), book.narrator()); }
+    void reserve(size_t items);
+
+    size_t size() const { return _kind.size(); }
+    bool empty() const { return _kind.empty(); }
+
+    MatKind kind(uint32_t i) const { return (MatKind)_kind[i]; }
+    const char *title(uint32_t i) const { return _titles.str(_title[i]); }
+    const char *author(uint32_t i) const { return _people.str(_author[i]); }
+    //没有朗读者时为空串
+    const char *narrator(uint32_t i) const { return _people.str(_narrator[i]); }
+
+    //以下查询要求索引是最新的，add之后先调用reindex
+    //作者为author的条目，下标升序
+    item_range by_author(const std::string &author) const;
+    //标题为title的条目，下标升序
+    item_range by_title(const std::string &title) const;
+    //标题以prefix开头的条目，按标题排序，标题相同的按下标升序
+    item_range by_title_prefix(const std::string &prefix) const;
+
+    //重建索引
+    void reindex();
+    //自上次reindex以来没有add
+    bool indexed() const { return !_dirty; }
+    //列、字符串与索引占用的堆内存，按容量计
+    size_t memory() const;
+
+private:
+    //前16字节按大端拼成的两个整数，不足补0，其大小顺序与strcmp一致
+    struct title_key
+    {
+        uint64_t head;
+        uint64_t tail;
+
+        bool operator<(const title_key &rhs) const { return head != rhs.head ? head < rhs.head : tail < rhs.tail; }
+        bool operator!=(const title_key &rhs) const { return head != rhs.head || tail != rhs.tail; }
+    };
+    static const size_t key_len = 2 * sizeof(uint64_t);
+
+    static uint64_t pack(const char *s, size_t len);
+    static title_key make_key(const char *s, size_t len) { return title_key{pack(s, len), len > 8 ? pack(s + 8, len - 8) : 0}; }
+    item_range title_ranks(size_t first, size_t last) const { return item_range(&_title_items[0] + _title_begin[first], &_title_items[0] + _title_begin[last]); }
+
+private:
+    StringPool _titles;
+    StringPool _people; //作者与朗读者
+    std::vector<uint8_t> _kind;
+    std::vector<uint32_t> _title;
+    std::vector<uint32_t> _author;
+    std::vector<uint32_t> _narrator;
+
+    bool _dirty;
+    //作者索引，作者id为a的条目为_author_items[_author_begin[a], _author_begin[a + 1])
+    std::vector<uint32_t> _author_begin;
+    std::vector<uint32_t> _author_items;
+    //标题索引，r为标题按字典序的名次
+    std::vector<uint32_t> _title_text;   //名次为r的标题在_titles.data()中的偏移
+    std::vector<title_key> _title_keys;  //名次为r的标题的make_key
+    std::vector<uint32_t> _title_rank;   //标题id对应的名次
+    std::vector<uint32_t> _title_begin;  //同_author_begin，按名次分桶
+    std::vector<uint32_t> _title_items;
+};
+
+inline uint64_t Catalog::pack(const char *s, size_t len)
+{
+    uint64_t key = 0;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        key = key << 8 | (i < len ? (unsigned char)s[i] : 0);
+    }
+    return key;
+}
+
+inline uint32_t Catalog::add(MatKind kind, const std::string &title, const std::string &author, const std::string &narrator)
+{
+    uint32_t i = _kind.size();
+    _kind.push_back(kind);
+    _title.push_back(_titles.intern(title));
+    _author.push_back(_people.intern(author));
+    _narrator.push_back(_people.intern(narrator));
+    _dirty = true;
+    return i;
+}
+
+inline void Catalog::reserve(size_t items)
+{
+    _kind.reserve(items);
+    _title.reserve(items);
+    _author.reserve(items);
+    _narrator.reserve(items);
+}
+
+/**
+ * @brief 两个索引都用计数排序分桶: 先数出每个桶的大小，前缀和得到各桶起点，再按下标顺序放入，桶内下标自然升序
+ *
+ */
+inline void Catalog::reindex()
+{
+    size_t n = _kind.size();
+
+    _author_begin.assign(_people.size() + 1, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ++_author_begin[_author[i] + 1];
+    }
+    for (size_t a = 1; a < _author_begin.size(); ++a)
+    {
+        _author_begin[a] += _author_begin[a - 1];
+    }
+    _author_items.resize(n);
+    std::vector<uint32_t> next(_author_begin.begin(), _author_begin.end() - 1);
+    for (size_t i = 0; i < n; ++i)
+    {
+        _author_items[next[_author[i]]++] = i;
+    }
+
+    //不同的标题先按make_key排序，相同时再比较整个字符串
+    size_t t = _titles.size();
+    std::vector<uint32_t> sorted(t);
+    std::vector<title_key> keys(t);
+    for (uint32_t id = 0; id < t; ++id)
+    {
+        sorted[id] = id;
+        keys[id] = make_key(_titles.str(id), _titles.length(id));
+    }
+    const StringPool &titles = _titles;
+    std::sort(sorted.begin(), sorted.end(), [&titles, &keys](uint32_t a, uint32_t b) {
+        return keys[a] != keys[b] ? keys[a] < keys[b] : strcmp(titles.str(a), titles.str(b)) < 0;
+    });
+    _title_text.resize(t);
+    _title_keys.resize(t);
+    _title_rank.resize(t);
+    for (uint32_t r = 0; r < t; ++r)
+    {
+        _title_text[r] = _titles.offset(sorted[r]);
+        _title_keys[r] = keys[sorted[r]];
+        _title_rank[sorted[r]] = r;
+    }
+
+    _title_begin.assign(t + 1, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ++_title_begin[_title_rank[_title[i]] + 1];
+    }
+    for (size_t r = 1; r <= t; ++r)
+    {
+        _title_begin[r] += _title_begin[r - 1];
+    }
+    _title_items.resize(n);
+    next.assign(_title_begin.begin(), _title_begin.end() - 1);
+    for (size_t i = 0; i < n; ++i)
+    {
+        _title_items[next[_title_rank[_title[i]]]++] = i;
+    }
+    _dirty = false;
+}
+
+inline Catalog::item_range Catalog::by_author(const std::string &author) const
+{
+    assert(!_dirty);
+    uint32_t id = _people.find(author);
+    if (id == StringPool::npos || _author_items.empty())
+    {
+        return item_range();
+    }
+    return item_range(&_author_items[0] + _author_begin[id], &_author_items[0] + _author_begin[id + 1]);
+}
+
+inline Catalog::item_range Catalog::by_title(const std::string &title) const
+{
+    assert(!_dirty);
+    uint32_t id = _titles.find(title);
+    if (id == StringPool::npos || _title_items.empty())
+    {
+        return item_range();
+    }
+    uint32_t r = _title_rank[id];
+    return title_ranks(r, r + 1);
+}
+
+inline Catalog::item_range Catalog::by_title_prefix(const std::string &prefix) const
+{
+    assert(!_dirty);
+    if (_title_items.empty())
+    {
+        return item_range();
+    }
+    //[lo, hi]为前len字节与prefix相同的所有键
+    size_t len = prefix.size();
+    title_key lo = make_key(prefix.data(), len);
+    title_key hi = lo;
+    if (len < 8)
+    {
+        hi.head |= ~0ull >> (8 * len);
+        hi.tail = ~0ull;
+    }
+    else if (len < key_len)
+    {
+        hi.tail |= ~0ull >> (8 * (len - 8));
+    }
+    const title_key *keys = &_title_keys[0];
+    size_t first = std::lower_bound(keys, keys + _title_keys.size(), lo) - keys;
+    size_t last = std::upper_bound(keys + first, keys + _title_keys.size(), hi) - keys;
+
+    //前16字节相同的标题按其余部分排序，在其中二分出以prefix开头的一段
+    if (len > key_len && first < last)
+    {
+        const char *rest = prefix.data() + key_len;
+        size_t rest_len = len - key_len;
+        const char *text = _titles.data() + key_len;
+        const uint32_t *offs = &_title_text[0];
+        first = std::lower_bound(offs + first, offs + last, rest, [text, rest_len](uint32_t off, const char *p) {
+                    return strncmp(text + off, p, rest_len) < 0;
+                }) - offs;
+        last = std::upper_bound(offs + first, offs + last, rest, [text, rest_len](const char *p, uint32_t off) {
+                   return strncmp(p, text + off, rest_len) < 0;
+               }) - offs;
+    }
+    return title_ranks(first, last);
+}
+
+inline size_t Catalog::memory() const
+{
+    size_t bytes = _titles.memory() + _people.memory() + _kind.capacity();
+    bytes += (_title.capacity() + _author.capacity() + _narrator.capacity()) * sizeof(uint32_t);
+    bytes += (_author_begin.capacity() + _author_items.capacity()) * sizeof(uint32_t);
+    bytes += (_title_text.capacity() + _title_rank.capacity() + _title_begin.capacity() + _title_items.capacity()) * sizeof(uint32_t);
+    bytes += _title_keys.capacity() * sizeof(title_key);
+    return bytes;
+}
+
+#endif /* __CATALOG_HPP__ */
@@ -12,12 +12,20 @@
 #define __LIBMAT_HPP__
 #include <iostream>
 #include <string>
+
+//编译时定义LIBMAT_TRACE才打印构造与析构的跟踪信息，默认编译掉，大量创建对象时不受iostream拖累
+#ifdef LIBMAT_TRACE
+#define LIBMAT_TRACE_LOG(msg) (std::cout << msg)
+#else
+#define LIBMAT_TRACE_LOG(msg) ((void)0)
+#endif
+
 class LibMat
 {
 public:
-    LibMat() { std::cout << "LibMat::LibMat() defult constructor!\n"; }
+    LibMat() { LIBMAT_TRACE_LOG("LibMat::LibMat() defult constructor!\n"); }
 
-    virtual ~LibMat() { std::cout << "LibMat::~LibMat() destructor!\n"; }
+    virtual ~LibMat() { LIBMAT_TRACE_LOG("LibMat::~LibMat() destructor!\n"); }
 
     virtual void print() const { std::cout << "LibMat::print() -- I am a libmat!\n"; }
 };
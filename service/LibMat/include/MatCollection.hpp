@@ -0,0 +1,103 @@
+/**
+ * @file MatCollection.hpp
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief 按具体类型分开存放的LibMat集合
+            ===============
+            代替std::vector<LibMat *>做批量处理: 每种具体类型一个按值存放的vector，遍历时不追指针、不走虚函数.
+            > * 类型集合是封闭的，目前为Book与AudioBook；其余子类还是空的声明，实现后各加一个vector与add重载
+            > * for_each(visitor)依次把每个对象以其具体类型传给visitor，visitor按类型重载operator()，调用可以内联
+            > * print按具体类型限定调用print，不经过虚表
+            > * 不保留加入的先后顺序，先遍历全部Book，再遍历全部AudioBook
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __MATCOLLECTION_HPP__
+#define __MATCOLLECTION_HPP__
+#include <utility>
+#include <vector>
+#include "AudioBook.hpp"
+
+class MatCollection
+{
+public:
+    void add(const Book &book) { _books.push_back(book); }
+    void add(Book &&book) { _books.push_back(std::move(book)); }
+    void add(const AudioBook &book) { _audiobooks.push_back(book); }
+    void add(AudioBook &&book) { _audiobooks.push_back(std::move(book)); }
+
+    std::vector<Book> &books() { return _books; }
+    const std::vector<Book> &books() const { return _books; }
+    std::vector<AudioBook> &audiobooks() { return _audiobooks; }
+    const std::vector<AudioBook> &audiobooks() const { return _audiobooks; }
+
+    size_t size() const { return _books.size() + _audiobooks.size(); }
+    bool empty() const { return size() == 0; }
+    void clear();
+    void reserve(size_t books, size_t audiobooks);
+
+    template <typename Visitor>
+    void for_each(Visitor &&visitor);
+    template <typename Visitor>
+    void for_each(Visitor &&visitor) const;
+
+    void print() const;
+
+private:
+    std::vector<Book> _books;
+    std::vector<AudioBook> _audiobooks;
+};
+
+inline void MatCollection::clear()
+{
+    _books.clear();
+    _audiobooks.clear();
+}
+
+inline void MatCollection::reserve(size_t books, size_t audiobooks)
+{
+    _books.reserve(books);
+    _audiobooks.reserve(audiobooks);
+}
+
+template <typename Visitor>
+inline void MatCollection::for_each(Visitor &&visitor)
+{
+    for (size_t i = 0; i < _books.size(); ++i)
+    {
+        visitor(_books[i]);
+    }
+    for (size_t i = 0; i < _audiobooks.size(); ++i)
+    {
+        visitor(_audiobooks[i]);
+    }
+}
+
+template <typename Visitor>
+inline void MatCollection::for_each(Visitor &&visitor) const
+{
+    for (size_t i = 0; i < _books.size(); ++i)
+    {
+        visitor(_books[i]);
+    }
+    for (size_t i = 0; i < _audiobooks.size(); ++i)
+    {
+        visitor(_audiobooks[i]);
+    }
+}
+
+inline void MatCollection::print() const
+{
+    for (size_t i = 0; i < _books.size(); ++i)
+    {
+        _books[i].Book::print();
+    }
+    for (size_t i = 0; i < _audiobooks.size(); ++i)
+    {
+        _audiobooks[i].AudioBook::print();
+    }
+}
+
+#endif /* __MATCOLLECTION_HPP__ */
@@ -0,0 +1,164 @@
+/**
+ * @file StringPool.hpp
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief 字符串驻留池
+            ===============
+            相同的字符串只保存一份，用32位id代替std::string，供Catalog的各列使用.
+            > * 所有字符串以'\0'结尾首尾相接存放在一块连续内存中，id即第几个字符串，id 0固定为空串
+            > * 开放寻址(线性探测)的哈希表把内容映射到id，负载不超过1/2，同时保存每个id的哈希值，扩容时不必重算
+            > * 只增不删，已有的id与str()返回的指针在下次intern之前有效
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __STRINGPOOL_HPP__
+#define __STRINGPOOL_HPP__
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+class StringPool
+{
+public:
+    enum : uint32_t
+    {
+        npos = 0xffffffffu
+    };
+
+    StringPool() : _slots(min_slots, npos)
+    {
+        _offsets.push_back(0);
+        intern("", 0);
+    }
+
+    //返回s的id，不存在时加入
+    uint32_t intern(const char *s, size_t len);
+    uint32_t intern(const std::string &s) { return intern(s.data(), s.size()); }
+
+    //返回s的id，不存在时返回npos
+    uint32_t find(const char *s, size_t len) const;
+    uint32_t find(const std::string &s) const { return find(s.data(), s.size()); }
+
+    const char *str(uint32_t id) const { return &_chars[_offsets[id]]; }
+    //str(id)在data()中的偏移，下次intern之前不变
+    uint32_t offset(uint32_t id) const { return _offsets[id]; }
+    const char *data() const { return &_chars[0]; }
+    size_t length(uint32_t id) const { return _offsets[id + 1] - _offsets[id] - 1; }
+    //不同的字符串个数，包括空串
+    size_t size() const { return _hashes.size(); }
+
+    void reserve(size_t strings, size_t chars);
+    //占用的堆内存，按容量计
+    size_t memory() const;
+
+private:
+    static const size_t min_slots = 16;
+
+    //FNV-1a
+    static uint32_t hash(const char *s, size_t len);
+    bool equal(uint32_t id, const char *s, size_t len) const { return length(id) == len && memcmp(str(id), s, len) == 0; }
+    void rehash(size_t slots);
+
+private:
+    std::vector<char> _chars;       //所有字符串的内容
+    std::vector<uint32_t> _offsets; //第id个字符串在_chars中的起点，末尾多一项
+    std::vector<uint32_t> _hashes;  //第id个字符串的哈希值
+    std::vector<uint32_t> _slots;   //哈希表，元素为id，空位为npos，大小为2的幂
+};
+
+inline uint32_t StringPool::hash(const char *s, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i)
+    {
+        h = (h ^ (unsigned char)s[i]) * 16777619u;
+    }
+    return h;
+}
+
+inline uint32_t StringPool::find(const char *s, size_t len) const
+{
+    uint32_t h = hash(s, len);
+    size_t mask = _slots.size() - 1;
+    for (size_t i = h & mask;; i = (i + 1) & mask)
+    {
+        uint32_t id = _slots[i];
+        if (id == npos)
+        {
+            return npos;
+        }
+        if (_hashes[id] == h && equal(id, s, len))
+        {
+            return id;
+        }
+    }
+}
+
+inline uint32_t StringPool::intern(const char *s, size_t len)
+{
+    uint32_t h = hash(s, len);
+    size_t mask = _slots.size() - 1;
+    size_t i = h & mask;
+    for (; _slots[i] != npos; i = (i + 1) & mask)
+    {
+        uint32_t id = _slots[i];
+        if (_hashes[id] == h && equal(id, s, len))
+        {
+            return id;
+        }
+    }
+
+    uint32_t id = _hashes.size();
+    _chars.insert(_chars.end(), s, s + len);
+    _chars.push_back('\0');
+    _offsets.push_back(_chars.size());
+    _hashes.push_back(h);
+    _slots[i] = id;
+    if (2 * _hashes.size() > _slots.size())
+    {
+        rehash(2 * _slots.size());
+    }
+    return id;
+}
+
+inline void StringPool::rehash(size_t slots)
+{
+    std::vector<uint32_t> fresh(slots, npos);
+    size_t mask = slots - 1;
+    for (uint32_t id = 0; id < _hashes.size(); ++id)
+    {
+        size_t i = _hashes[id] & mask;
+        while (fresh[i] != npos)
+        {
+            i = (i + 1) & mask;
+        }
+        fresh[i] = id;
+    }
+    _slots.swap(fresh);
+}
+
+inline void StringPool::reserve(size_t strings, size_t chars)
+{
+    _chars.reserve(chars);
+    _offsets.reserve(strings + 1);
+    _hashes.reserve(strings);
+    size_t slots = _slots.size();
+    while (slots < 2 * strings)
+    {
+        slots *= 2;
+    }
+    if (slots != _slots.size())
+    {
+        rehash(slots);
+    }
+}
+
+inline size_t StringPool::memory() const
+{
+    return _chars.capacity() + (_offsets.capacity() + _hashes.capacity() + _slots.capacity()) * sizeof(uint32_t);
+}
+
+#endif /* __STRINGPOOL_HPP__ */
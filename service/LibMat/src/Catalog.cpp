@@ -0,0 +1 @@
+#include "../include/Catalog.hpp"
\ No newline at end of file
@@ -0,0 +1 @@
+#include "../include/MatCollection.hpp"
\ No newline at end of file
@@ -0,0 +1 @@
+#include "../include/StringPool.hpp"
\ No newline at end of file
@@ -34,7 +34,7 @@ void connection_pool::init(string url, string User, string PassWord, string DBNa
     for (int i = 0; i < MaxConn; i++)
     {
         MYSQL *conn = nullptr;
-        conn = mysql_init();
+        conn = mysql_init(conn);
 
         if (conn == nullptr)
         {
@@ -42,15 +42,15 @@ void connection_pool::init(string url, string User, string PassWord, string DBNa
             exit(1);
         }
 
-        conn = mysql_real_connect(con, url.c_str(), User.c_str(), PassWord.c_str(), DBName.c_str(), Port, nullptr, 0);
+        conn = mysql_real_connect(conn, url.c_str(), User.c_str(), PassWord.c_str(), DBName.c_str(), Port, nullptr, 0);
 
-        if (con == nullptr)
+        if (conn == nullptr)
         {
             LOG_ERROR("Mysql Error");
             exit(1);
         }
 
-        connList.push_back(con);
+        connList.push_back(conn);
         ++m_FreeConn;
     }
 
@@ -72,7 +72,7 @@ MYSQL *connection_pool::GetConnection()
     reserve.wait();
     lock.lock();
     con = connList.front();
-    conList.pop_front();
+    connList.pop_front();
     --m_FreeConn;
     ++m_CurConn;
     lock.unlock();
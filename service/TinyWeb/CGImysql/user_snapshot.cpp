@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "user_snapshot.h"
+
+using namespace std;
+
+static const char SNAPSHOT_MAGIC[8] = {'T', 'W', 'U', 'S', 'N', 'A', 'P', '2'};
+
+struct snapshot_header
+{
+    char magic[8];
+    uint64_t max_id;
+    uint64_t rows;
+    uint64_t checksum;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+user_snapshot::user_snapshot() : m_base(nullptr), m_size(0), m_offsets(nullptr), m_count(0)
+{
+}
+
+user_snapshot::~user_snapshot()
+{
+    close();
+}
+
+bool user_snapshot::open(const char *path)
+{
+    close();
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(snapshot_header))
+    {
+        ::close(fd);
+        return false;
+    }
+    void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        return false;
+    }
+
+    const snapshot_header *h = (const snapshot_header *)addr;
+    if (memcmp(h->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        sizeof(snapshot_header) + (size_t)h->count * sizeof(uint32_t) > (size_t)st.st_size ||
+        ((const char *)addr)[st.st_size - 1] != '\0')
+    {
+        munmap(addr, st.st_size);
+        return false;
+    }
+    //逐个检查偏移表: 每个条目的用户名与密码都须落在字符串区内,且用户名严格升序,损坏的文件不能越界读
+    const char *base = (const char *)addr;
+    const uint32_t *offsets = (const uint32_t *)(base + sizeof(snapshot_header));
+    size_t strings = sizeof(snapshot_header) + (size_t)h->count * sizeof(uint32_t);
+    const char *prev = nullptr;
+    for (uint32_t i = 0; i < h->count; ++i)
+    {
+        size_t off = offsets[i];
+        const char *name_end = off >= strings && off < (size_t)st.st_size
+                                   ? (const char *)memchr(base + off, '\0', st.st_size - off)
+                                   : nullptr;
+        //密码从name_end + 1开始,文件末字节为'\0',只要起点在文件内就能终止
+        if (!name_end || name_end + 1 >= base + st.st_size || (prev && strcmp(prev, base + off) >= 0))
+        {
+            munmap(addr, st.st_size);
+            return false;
+        }
+        prev = base + off;
+    }
+
+    m_base = (char *)addr;
+    m_size = st.st_size;
+    m_offsets = offsets;
+    m_count = h->count;
+    m_mark.max_id = h->max_id;
+    m_mark.rows = h->rows;
+    m_mark.checksum = h->checksum;
+    //查找是随机访问,不需要内核预读
+    madvise(m_base, m_size, MADV_RANDOM);
+    return true;
+}
+
+void user_snapshot::close()
+{
+    if (m_base)
+    {
+        munmap(m_base, m_size);
+        m_base = nullptr;
+    }
+    m_size = 0;
+    m_offsets = nullptr;
+    m_count = 0;
+    m_mark = user_table_mark();
+}
+
+const char *user_snapshot::find(const char *name) const
+{
+    uint32_t lo = 0, hi = m_count;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        const char *e = name_at(mid);
+        int cmp = strcmp(name, e);
+        if (cmp == 0)
+        {
+            return e + strlen(e) + 1;
+        }
+        if (cmp < 0)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 按用户名顺序遍历base与delta的归并结果
+ *
+ */
+template <typename F>
+static void merge(const user_snapshot *base, const map<string, string> &delta, F f)
+{
+    uint32_t i = 0;
+    uint32_t n = base ? base->count() : 0;
+    map<string, string>::const_iterator it = delta.begin();
+    while (i < n || it != delta.end())
+    {
+        const char *name = i < n ? base->name_at(i) : nullptr;
+        int cmp = !name ? 1 : (it == delta.end() ? -1 : strcmp(name, it->first.c_str()));
+        if (cmp < 0)
+        {
+            f(name, strlen(name), name + strlen(name) + 1);
+            ++i;
+        }
+        else
+        {
+            f(it->first.c_str(), it->first.size(), it->second.c_str());
+            if (cmp == 0)
+            {
+                ++i;
+            }
+            ++it;
+        }
+    }
+}
+
+bool user_snapshot::write(const char *path, const user_snapshot *base, const map<string, string> &delta, const user_table_mark &mark)
+{
+    //第一遍统计条目数,第二遍写偏移表,第三遍写字符串区
+    uint32_t count = 0;
+    merge(base, delta, [&](const char *, size_t, const char *) { ++count; });
+
+    string tmp = string(path) + ".tmp";
+    FILE *fp = fopen(tmp.c_str(), "wb");
+    if (!fp)
+    {
+        return false;
+    }
+    snapshot_header h;
+    memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.max_id = mark.max_id;
+    h.rows = mark.rows;
+    h.checksum = mark.checksum;
+    h.count = count;
+    h.reserved = 0;
+    bool ok = fwrite(&h, sizeof(h), 1, fp) == 1;
+
+    uint64_t off = sizeof(h) + (uint64_t)count * sizeof(uint32_t);
+    merge(base, delta, [&](const char *, size_t name_len, const char *passwd) {
+        uint32_t o = off;
+        ok = ok && off <= UINT32_MAX && fwrite(&o, sizeof(o), 1, fp) == 1;
+        off += name_len + 1 + strlen(passwd) + 1;
+    });
+    merge(base, delta, [&](const char *name, size_t name_len, const char *passwd) {
+        ok = ok && fwrite(name, name_len + 1, 1, fp) == 1 && fwrite(passwd, strlen(passwd) + 1, 1, fp) == 1;
+    });
+
+    ok = fflush(fp) == 0 && ok;
+    ok = fsync(fileno(fp)) == 0 && ok;
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(tmp.c_str(), path) < 0)
+    {
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file user_snapshot.h
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief 用户表快照
+            ===============
+            把用户名与密码保存为按用户名排序、可直接mmap的文件,启动时不再把整张user表读进std::map.
+            > * 文件布局: 文件头 | 按用户名排序的偏移表(uint32) | "用户名\0密码\0"字符串区
+            > * 查找在偏移表上二分；open时检查每个偏移与字符串都在文件范围内且用户名升序,拒绝截断或损坏的文件
+            > * 文件头记录快照对应的自增id上限max_id,以及id不超过max_id的行数与各行crc32的异或
+            > * 启动时先在数据库中按同样方式核对id不超过max_id的行,一致才使用快照,再按id顺序读取其后新增的行
+            > * 重写快照时与内存中的增量归并,写临时文件后rename,读者始终看到完整的文件
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __USER_SNAPSHOT_H__
+#define __USER_SNAPSHOT_H__
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <string>
+
+//快照对应的数据库状态: id不超过max_id的行数,以及这些行crc32(concat_ws(0x00, id, 用户名, 密码))的异或
+struct user_table_mark
+{
+    uint64_t max_id;
+    uint64_t rows;
+    uint64_t checksum;
+
+    user_table_mark() : max_id(0), rows(0), checksum(0) {}
+};
+
+class user_snapshot
+{
+public:
+    user_snapshot();
+    ~user_snapshot();
+
+    /**
+     * @brief 映射快照文件
+     *
+     * @param path
+     * @return false 文件不存在或格式不对
+     */
+    bool open(const char *path);
+    void close();
+
+    //返回用户的密码,不存在时返回nullptr
+    const char *find(const char *name) const;
+
+    //生成快照时对应的数据库状态
+    const user_table_mark &mark() const { return m_mark; }
+    uint32_t count() const { return m_count; }
+
+    //按用户名排序的第i个条目,密码紧随用户名的'\0'之后
+    const char *name_at(uint32_t i) const { return m_base + m_offsets[i]; }
+
+    /**
+     * @brief 将base与delta归并后写入path,同名用户以delta为准
+     *
+     * @param path
+     * @param base 可以为nullptr
+     * @param delta
+     * @param mark 写入文件头的数据库状态,须与base和delta的内容一致
+     * @return false 写文件失败,原文件不受影响
+     */
+    static bool write(const char *path, const user_snapshot *base,
+                      const std::map<std::string, std::string> &delta, const user_table_mark &mark);
+
+private:
+    char *m_base;
+    size_t m_size;
+    const uint32_t *m_offsets;
+    uint32_t m_count;
+    user_table_mark m_mark;
+};
+
+#endif /* __USER_SNAPSHOT_H__ */
@@ -0,0 +1,54 @@
+#!/bin/bash
+# 用同一组压测参数依次比较 epoll(-i 0) 与 io_uring(-i 1) 两种后端的吞吐与每请求系统调用数
+# 用法: sh ./bench/compare_backends.sh [端口] [每组秒数]，需在 TinyWeb 目录下执行
+# 系统调用数依赖 strace，未安装时只比较吞吐
+
+PORT=${1:-9097}
+DURATION=${2:-10}
+
+make DEBUG=0 bench || exit 1
+
+USERS=$(mktemp)
+echo "bench bench" > $USERS
+TRACE=$(mktemp)
+
+STRACE=$(command -v strace)
+
+run() {
+    BACKEND=$1
+    shift
+    if [ -n "$STRACE" ]; then
+        TINYWEB_STUB_USERS=$USERS $STRACE -f -c -o $TRACE ./server_bench -p $PORT -c 1 -t 8 -i $BACKEND &
+    else
+        TINYWEB_STUB_USERS=$USERS ./server_bench -p $PORT -c 1 -t 8 -i $BACKEND &
+    fi
+    SERVER=$!
+    sleep 1
+
+    OUT=$(./http_bench -p $PORT -d $DURATION -j "$@")
+    echo "backend=$BACKEND $OUT"
+
+    kill $SERVER
+    wait $SERVER 2>/dev/null
+    if [ -n "$STRACE" ]; then
+        REQS=$(echo "$OUT" | sed -n 's/.*"requests":\([0-9]*\).*/\1/p')
+        CALLS=$(awk '$NF == "total" { print $(NF-2) }' $TRACE)
+        if [ -n "$REQS" ] && [ "$REQS" -gt 0 ]; then
+            echo "backend=$BACKEND syscalls/request $(awk -v c=$CALLS -v r=$REQS 'BEGIN { printf "%.2f", c / r }')"
+        fi
+    fi
+}
+
+compare() {
+    echo "== $*"
+    run 0 "$@"
+    run 1 "$@"
+}
+
+compare -c 64 -k 1 -x 100:0:0
+compare -c 64 -k 0 -x 100:0:0
+compare -c 64 -k 1 -x 90:9:1
+# 大文件走 splice
+compare -c 16 -k 1 -x 100:0:0 -f login.gif
+
+rm -f $USERS $TRACE
@@ -0,0 +1,784 @@
+/**
+ * @file http_bench.cpp
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief TinyWeb 端到端压测客户端
+            ===============
+            多线程 + 每线程一个 epoll 的非阻塞压测工具，用来在发布前发现吞吐和时延的退化.
+            > * 闭环模式: 每条连接收到响应后立即发下一个请求
+            > * 开环模式(-r): 按固定总速率发请求，时延从计划发送时刻算起，避免协同遗漏
+            > * 长连接(keep-alive)与短连接
+            > * GET root/ 下的静态文件与 POST 登录/注册 CGI 混合
+            > * 输出 p50/p99/p999 时延与每秒请求数
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const int READ_BUF_SIZE = 64 * 1024;
+static const int MAX_EVENTS = 1024;
+
+/**
+ * @brief 对数-线性时延直方图(微秒)，每个二进制数量级再细分 32 格，相对误差约 3%
+ *
+ */
+class latency_histogram
+{
+public:
+    static const int SUB_BITS = 5;
+    static const int SUB_COUNT = 1 << SUB_BITS;
+    static const int BUCKETS = 64 * SUB_COUNT;
+
+    latency_histogram() : m_counts(BUCKETS, 0), m_total(0), m_sum(0), m_max(0) {}
+
+    void record(uint64_t us)
+    {
+        m_counts[index_of(us)]++;
+        m_total++;
+        m_sum += us;
+        if (us > m_max)
+        {
+            m_max = us;
+        }
+    }
+
+    void merge(const latency_histogram &rhs)
+    {
+        for (int i = 0; i < BUCKETS; ++i)
+        {
+            m_counts[i] += rhs.m_counts[i];
+        }
+        m_total += rhs.m_total;
+        m_sum += rhs.m_sum;
+        if (rhs.m_max > m_max)
+        {
+            m_max = rhs.m_max;
+        }
+    }
+
+    uint64_t percentile(double p) const
+    {
+        if (m_total == 0)
+        {
+            return 0;
+        }
+        uint64_t rank = (uint64_t)(p / 100.0 * m_total);
+        if (rank >= m_total)
+        {
+            rank = m_total - 1;
+        }
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; ++i)
+        {
+            seen += m_counts[i];
+            if (seen > rank)
+            {
+                uint64_t v = upper_of(i);
+                return v < m_max ? v : m_max;
+            }
+        }
+        return m_max;
+    }
+
+    uint64_t total() const { return m_total; }
+    uint64_t max() const { return m_max; }
+    double mean() const { return m_total ? (double)m_sum / m_total : 0.0; }
+
+private:
+    static int index_of(uint64_t v)
+    {
+        if (v < (uint64_t)SUB_COUNT)
+        {
+            return (int)v;
+        }
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - SUB_BITS;
+        return (shift + 1) * SUB_COUNT + (int)((v >> shift) & (SUB_COUNT - 1));
+    }
+
+    static uint64_t upper_of(int idx)
+    {
+        if (idx < SUB_COUNT)
+        {
+            return idx;
+        }
+        int shift = idx / SUB_COUNT - 1;
+        uint64_t sub = idx % SUB_COUNT;
+        return ((SUB_COUNT + sub + 1) << shift) - 1;
+    }
+
+    vector<uint64_t> m_counts;
+    uint64_t m_total;
+    uint64_t m_sum;
+    uint64_t m_max;
+};
+
+enum REQUEST_KIND
+{
+    REQ_GET = 0,
+    REQ_LOGIN,
+    REQ_REGISTER
+};
+
+struct bench_config
+{
+    string host;
+    int port;
+    int threads;
+    int connections;
+    int duration;
+    int warmup;
+    double rate;      // 总请求速率，0 表示闭环
+    int keep_alive;   // 1 长连接，0 每个请求一条连接
+    int weight[3];    // GET/登录/注册 的权重
+    vector<string> files;
+    string user;
+    string passwd;
+    int json;
+};
+
+/**
+ * @brief 压测连接的状态
+ *
+ */
+enum CONN_STATE
+{
+    CONN_IDLE = 0,   //长连接空闲，等待下一次发送(仅开环)
+    CONN_CONNECTING, //非阻塞 connect 进行中
+    CONN_SENDING,
+    CONN_RECEIVING,
+    CONN_CLOSED
+};
+
+struct bench_conn
+{
+    int fd;
+    CONN_STATE state;
+    string request;
+    size_t sent;
+    string response; //已收到的响应头
+    long header_end; //响应头结束位置，-1 表示未收齐
+    long body_left;  //还需读取的响应体字节数
+    int status;
+    bool server_close;
+    uint64_t start_ns; //该请求计时起点
+};
+
+struct thread_stats
+{
+    latency_histogram hist;
+    uint64_t completed;
+    uint64_t errors;
+    uint64_t non_2xx;
+    uint64_t bytes;
+    uint64_t connects;
+};
+
+struct bench_thread
+{
+    const bench_config *cfg;
+    int id;
+    int nconn;
+    double rate; //本线程的速率
+    thread_stats stats;
+    pthread_t tid;
+};
+
+static sockaddr_in g_addr;
+static volatile bool g_recording = false;
+static volatile bool g_stop = false;
+
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-h host] [-p port] [-t threads] [-c connections] [-d seconds]\n"
+            "          [-w warmup_seconds] [-r total_rate] [-k keep_alive] [-x get:login:register]\n"
+            "          [-f file1,file2,...] [-u user] [-P passwd] [-j]\n",
+            prog);
+}
+
+static void split_files(const char *arg, vector<string> &out)
+{
+    out.clear();
+    string s(arg);
+    size_t pos = 0;
+    while (pos <= s.size())
+    {
+        size_t comma = s.find(',', pos);
+        if (comma == string::npos)
+        {
+            comma = s.size();
+        }
+        if (comma > pos)
+        {
+            out.push_back(s.substr(pos, comma - pos));
+        }
+        pos = comma + 1;
+    }
+}
+
+/**
+ * @brief 按权重挑选本次请求并生成报文
+ *
+ */
+static void build_request(const bench_config *cfg, bench_thread *t, uint64_t seq, unsigned int *seed, string &out)
+{
+    int total = cfg->weight[REQ_GET] + cfg->weight[REQ_LOGIN] + cfg->weight[REQ_REGISTER];
+    int pick = total > 0 ? rand_r(seed) % total : 0;
+    const char *conn_hdr = cfg->keep_alive ? "keep-alive" : "close";
+    char buf[512];
+    if (pick < cfg->weight[REQ_GET])
+    {
+        const string &file = cfg->files[rand_r(seed) % cfg->files.size()];
+        snprintf(buf, sizeof(buf), "GET /%s HTTP/1.1\r\nHost: %s\r\nConnection: %s\r\n\r\n",
+                 file.c_str(), cfg->host.c_str(), conn_hdr);
+        out = buf;
+        return;
+    }
+
+    char body[256];
+    const char *url;
+    if (pick < cfg->weight[REQ_GET] + cfg->weight[REQ_LOGIN])
+    {
+        url = "/2CGISQL.cgi";
+        snprintf(body, sizeof(body), "user=%s&passwd=%s", cfg->user.c_str(), cfg->passwd.c_str());
+    }
+    else
+    {
+        url = "/3CGISQL.cgi";
+        snprintf(body, sizeof(body), "user=b%d_%llu_%d&passwd=bench", t->id, (unsigned long long)seq, getpid());
+    }
+    snprintf(buf, sizeof(buf), "POST %s HTTP/1.1\r\nHost: %s\r\nConnection: %s\r\nContent-Length: %zu\r\n\r\n%s",
+             url, cfg->host.c_str(), conn_hdr, strlen(body), body);
+    out = buf;
+}
+
+static bool open_conn(int epfd, bench_conn &c, thread_stats &st)
+{
+    c.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (c.fd < 0)
+    {
+        return false;
+    }
+    int one = 1;
+    setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    int ret = connect(c.fd, (struct sockaddr *)&g_addr, sizeof(g_addr));
+    if (ret < 0 && errno != EINPROGRESS)
+    {
+        close(c.fd);
+        c.fd = -1;
+        return false;
+    }
+    if (g_recording)
+    {
+        st.connects++;
+    }
+    c.state = ret == 0 ? CONN_SENDING : CONN_CONNECTING;
+
+    epoll_event ev;
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+    ev.data.ptr = &c;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, c.fd, &ev);
+    return true;
+}
+
+static void close_conn(int epfd, bench_conn &c)
+{
+    if (c.fd >= 0)
+    {
+        epoll_ctl(epfd, EPOLL_CTL_DEL, c.fd, 0);
+        close(c.fd);
+    }
+    c.fd = -1;
+    c.state = CONN_CLOSED;
+}
+
+static void set_events(int epfd, bench_conn &c, uint32_t events)
+{
+    epoll_event ev;
+    ev.events = events | EPOLLRDHUP;
+    ev.data.ptr = &c;
+    epoll_ctl(epfd, EPOLL_CTL_MOD, c.fd, &ev);
+}
+
+/**
+ * @brief 开始一次请求；短连接模式下先建立新连接
+ *
+ */
+static bool start_request(int epfd, bench_thread *t, bench_conn &c, uint64_t start_ns, uint64_t seq, unsigned int *seed)
+{
+    if (c.fd < 0 && !open_conn(epfd, c, t->stats))
+    {
+        if (g_recording)
+        {
+            t->stats.errors++;
+        }
+        return false;
+    }
+    build_request(t->cfg, t, seq, seed, c.request);
+    c.sent = 0;
+    c.response.clear();
+    c.header_end = -1;
+    c.body_left = 0;
+    c.status = 0;
+    c.server_close = false;
+    c.start_ns = start_ns;
+    if (c.state == CONN_IDLE)
+    {
+        c.state = CONN_SENDING;
+    }
+    if (c.state == CONN_SENDING)
+    {
+        set_events(epfd, c, EPOLLOUT);
+    }
+    return true;
+}
+
+/**
+ * @brief 解析响应头，取得状态码、Content-Length 与是否要求关闭连接
+ *
+ */
+static bool parse_response_header(bench_conn &c)
+{
+    size_t end = c.response.find("\r\n\r\n");
+    if (end == string::npos)
+    {
+        return false;
+    }
+    c.header_end = end + 4;
+    const char *p = c.response.c_str();
+    const char *sp = strchr(p, ' ');
+    c.status = sp ? atoi(sp + 1) : 0;
+
+    long content_length = 0;
+    const char *line = strstr(p, "\r\n");
+    while (line && line + 2 < p + end)
+    {
+        line += 2;
+        if (strncasecmp(line, "Content-Length:", 15) == 0)
+        {
+            content_length = atol(line + 15 + strspn(line + 15, " \t"));
+        }
+        else if (strncasecmp(line, "Connection:", 11) == 0)
+        {
+            const char *v = line + 11 + strspn(line + 11, " \t");
+            c.server_close = strncasecmp(v, "close", 5) == 0;
+        }
+        line = strstr(line, "\r\n");
+    }
+    long have = (long)c.response.size() - c.header_end;
+    c.body_left = content_length - have;
+    return true;
+}
+
+static void finish_request(bench_thread *t, bench_conn &c, uint64_t now)
+{
+    if (g_recording)
+    {
+        t->stats.hist.record((now - c.start_ns) / 1000);
+        t->stats.completed++;
+        if (c.status < 200 || c.status >= 300)
+        {
+            t->stats.non_2xx++;
+        }
+    }
+}
+
+/**
+ * @brief 处理可读事件，响应收齐返回 1，需继续等待返回 0，出错返回 -1
+ *
+ */
+static int on_readable(bench_thread *t, bench_conn &c, char *buf)
+{
+    while (true)
+    {
+        ssize_t n = recv(c.fd, buf, READ_BUF_SIZE, 0);
+        if (n < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return 0;
+            }
+            return -1;
+        }
+        if (n == 0)
+        {
+            return -1;
+        }
+        if (g_recording)
+        {
+            t->stats.bytes += n;
+        }
+        if (c.header_end < 0)
+        {
+            c.response.append(buf, n);
+            if (!parse_response_header(c))
+            {
+                continue;
+            }
+        }
+        else
+        {
+            c.body_left -= n;
+        }
+        if (c.body_left <= 0)
+        {
+            return 1;
+        }
+    }
+}
+
+static int on_writable(bench_conn &c)
+{
+    while (c.sent < c.request.size())
+    {
+        ssize_t n = send(c.fd, c.request.data() + c.sent, c.request.size() - c.sent, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return 0;
+            }
+            return -1;
+        }
+        c.sent += n;
+    }
+    return 1;
+}
+
+static void *bench_worker(void *arg)
+{
+    bench_thread *t = (bench_thread *)arg;
+    const bench_config *cfg = t->cfg;
+    unsigned int seed = 0x9e3779b9u ^ (t->id * 2654435761u);
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    vector<bench_conn> conns(t->nconn);
+    vector<int> idle;   //开环模式下可用的空闲连接
+    uint64_t backlog = 0; //开环模式下已到期但没有空闲连接的请求数
+    vector<uint64_t> backlog_start;
+    uint64_t seq = 0;
+    char *buf = new char[READ_BUF_SIZE];
+    epoll_event events[MAX_EVENTS];
+
+    bool open_loop = t->rate > 0;
+    uint64_t interval_ns = open_loop ? (uint64_t)(1e9 / t->rate) : 0;
+    uint64_t next_send = now_ns();
+
+    for (int i = 0; i < t->nconn; ++i)
+    {
+        conns[i].fd = -1;
+        conns[i].state = CONN_CLOSED;
+        if (open_loop)
+        {
+            idle.push_back(i);
+        }
+        else
+        {
+            start_request(epfd, t, conns[i], now_ns(), seq++, &seed);
+        }
+    }
+
+    while (!g_stop)
+    {
+        struct timespec timeout = {0, 100 * 1000000};
+        if (open_loop)
+        {
+            uint64_t now = now_ns();
+            while (next_send <= now)
+            {
+                backlog_start.push_back(next_send);
+                backlog++;
+                next_send += interval_ns;
+            }
+            while (backlog > 0 && !idle.empty())
+            {
+                int i = idle.back();
+                idle.pop_back();
+                uint64_t start = backlog_start[backlog_start.size() - backlog];
+                backlog--;
+                if (!start_request(epfd, t, conns[i], start, seq++, &seed))
+                {
+                    idle.push_back(i);
+                    break;
+                }
+            }
+            if (backlog == 0)
+            {
+                backlog_start.clear();
+            }
+            uint64_t wait_ns = next_send > now ? next_send - now : 0;
+            timeout.tv_sec = wait_ns / 1000000000ull;
+            timeout.tv_nsec = wait_ns % 1000000000ull;
+        }
+
+        //开环模式的发送间隔常低于 1ms，用纳秒精度的 epoll_pwait2 避免空转
+        int n = epoll_pwait2(epfd, events, MAX_EVENTS, &timeout, nullptr);
+        uint64_t now = now_ns();
+        for (int i = 0; i < n; ++i)
+        {
+            bench_conn &c = *(bench_conn *)events[i].data.ptr;
+            int idx = (int)(&c - &conns[0]);
+            int ret = 0;
+            if (c.state == CONN_CONNECTING)
+            {
+                int err = 0;
+                socklen_t len = sizeof(err);
+                getsockopt(c.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                if (err != 0 || (events[i].events & (EPOLLERR | EPOLLHUP)))
+                {
+                    ret = -1;
+                }
+                else
+                {
+                    c.state = CONN_SENDING;
+                }
+            }
+            if (ret == 0 && c.state == CONN_SENDING)
+            {
+                ret = on_writable(c);
+                if (ret == 1)
+                {
+                    c.state = CONN_RECEIVING;
+                    set_events(epfd, c, EPOLLIN);
+                    ret = 0;
+                }
+            }
+            else if (ret == 0 && c.state == CONN_RECEIVING && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
+            {
+                ret = on_readable(t, c, buf);
+                if (ret == 1)
+                {
+                    finish_request(t, c, now);
+                    if (!cfg->keep_alive || c.server_close)
+                    {
+                        close_conn(epfd, c);
+                    }
+                    else
+                    {
+                        c.state = CONN_IDLE;
+                    }
+                    if (open_loop)
+                    {
+                        idle.push_back(idx);
+                    }
+                    else
+                    {
+                        start_request(epfd, t, c, now, seq++, &seed);
+                    }
+                    continue;
+                }
+            }
+            else if (ret == 0 && c.state == CONN_IDLE && (events[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
+            {
+                //服务器关闭了空闲的长连接，下次发送时重连
+                close_conn(epfd, c);
+                continue;
+            }
+
+            if (ret < 0)
+            {
+                if (g_recording)
+                {
+                    t->stats.errors++;
+                }
+                close_conn(epfd, c);
+                if (open_loop)
+                {
+                    idle.push_back(idx);
+                }
+                else
+                {
+                    start_request(epfd, t, c, now_ns(), seq++, &seed);
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < t->nconn; ++i)
+    {
+        close_conn(epfd, conns[i]);
+    }
+    close(epfd);
+    delete[] buf;
+    return nullptr;
+}
+
+int main(int argc, char *argv[])
+{
+    bench_config cfg;
+    cfg.host = "127.0.0.1";
+    cfg.port = 9006;
+    cfg.threads = 4;
+    cfg.connections = 64;
+    cfg.duration = 10;
+    cfg.warmup = 2;
+    cfg.rate = 0;
+    cfg.keep_alive = 1;
+    cfg.weight[REQ_GET] = 90;
+    cfg.weight[REQ_LOGIN] = 9;
+    cfg.weight[REQ_REGISTER] = 1;
+    split_files("judge.html,log.html,register.html,picture.html,welcome.html", cfg.files);
+    cfg.user = "bench";
+    cfg.passwd = "bench";
+    cfg.json = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "h:p:t:c:d:w:r:k:x:f:u:P:j")) != -1)
+    {
+        switch (opt)
+        {
+        case 'h':
+            cfg.host = optarg;
+            break;
+        case 'p':
+            cfg.port = atoi(optarg);
+            break;
+        case 't':
+            cfg.threads = atoi(optarg);
+            break;
+        case 'c':
+            cfg.connections = atoi(optarg);
+            break;
+        case 'd':
+            cfg.duration = atoi(optarg);
+            break;
+        case 'w':
+            cfg.warmup = atoi(optarg);
+            break;
+        case 'r':
+            cfg.rate = atof(optarg);
+            break;
+        case 'k':
+            cfg.keep_alive = atoi(optarg);
+            break;
+        case 'x':
+            if (sscanf(optarg, "%d:%d:%d", &cfg.weight[REQ_GET], &cfg.weight[REQ_LOGIN], &cfg.weight[REQ_REGISTER]) != 3)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'f':
+            split_files(optarg, cfg.files);
+            break;
+        case 'u':
+            cfg.user = optarg;
+            break;
+        case 'P':
+            cfg.passwd = optarg;
+            break;
+        case 'j':
+            cfg.json = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (cfg.threads <= 0 || cfg.connections < cfg.threads || cfg.files.empty())
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    memset(&g_addr, 0, sizeof(g_addr));
+    g_addr.sin_family = AF_INET;
+    g_addr.sin_port = htons(cfg.port);
+    if (inet_pton(AF_INET, cfg.host.c_str(), &g_addr.sin_addr) != 1)
+    {
+        fprintf(stderr, "invalid host %s\n", cfg.host.c_str());
+        return 1;
+    }
+
+    vector<bench_thread> threads(cfg.threads);
+    for (int i = 0; i < cfg.threads; ++i)
+    {
+        bench_thread &t = threads[i];
+        t.cfg = &cfg;
+        t.id = i;
+        t.nconn = cfg.connections / cfg.threads + (i < cfg.connections % cfg.threads ? 1 : 0);
+        t.rate = cfg.rate / cfg.threads;
+        t.stats.completed = t.stats.errors = t.stats.non_2xx = t.stats.bytes = t.stats.connects = 0;
+        pthread_create(&t.tid, nullptr, bench_worker, &t);
+    }
+
+    sleep(cfg.warmup);
+    g_recording = true;
+    uint64_t begin = now_ns();
+    sleep(cfg.duration);
+    g_recording = false;
+    double elapsed = (now_ns() - begin) / 1e9;
+    g_stop = true;
+
+    thread_stats total;
+    total.completed = total.errors = total.non_2xx = total.bytes = total.connects = 0;
+    for (int i = 0; i < cfg.threads; ++i)
+    {
+        pthread_join(threads[i].tid, nullptr);
+        const thread_stats &st = threads[i].stats;
+        total.hist.merge(st.hist);
+        total.completed += st.completed;
+        total.errors += st.errors;
+        total.non_2xx += st.non_2xx;
+        total.bytes += st.bytes;
+        total.connects += st.connects;
+    }
+
+    double rps = total.completed / elapsed;
+    if (cfg.json)
+    {
+        printf("{\"mode\":\"%s\",\"keep_alive\":%d,\"threads\":%d,\"connections\":%d,\"rate\":%.0f,"
+               "\"duration\":%.3f,\"requests\":%llu,\"rps\":%.1f,\"errors\":%llu,\"non_2xx\":%llu,"
+               "\"bytes\":%llu,\"connects\":%llu,\"conn_per_sec\":%.1f,\"mean_us\":%.1f,\"p50_us\":%llu,\"p99_us\":%llu,\"p999_us\":%llu,\"max_us\":%llu}\n",
+               cfg.rate > 0 ? "open" : "closed", cfg.keep_alive, cfg.threads, cfg.connections, cfg.rate,
+               elapsed, (unsigned long long)total.completed, rps, (unsigned long long)total.errors,
+               (unsigned long long)total.non_2xx, (unsigned long long)total.bytes,
+               (unsigned long long)total.connects, total.connects / elapsed, total.hist.mean(),
+               (unsigned long long)total.hist.percentile(50), (unsigned long long)total.hist.percentile(99),
+               (unsigned long long)total.hist.percentile(99.9), (unsigned long long)total.hist.max());
+        return 0;
+    }
+
+    printf("%s loop, %s, %d threads, %d connections", cfg.rate > 0 ? "open" : "closed",
+           cfg.keep_alive ? "keep-alive" : "short-lived", cfg.threads, cfg.connections);
+    if (cfg.rate > 0)
+    {
+        printf(", target %.0f req/s", cfg.rate);
+    }
+    printf("\n");
+    printf("  requests   %llu in %.2fs, %.1f req/s, %.2f MB/s\n", (unsigned long long)total.completed,
+           elapsed, rps, total.bytes / elapsed / (1024 * 1024));
+    printf("  errors     %llu, non-2xx %llu, connects %llu (%.1f conn/s)\n", (unsigned long long)total.errors,
+           (unsigned long long)total.non_2xx, (unsigned long long)total.connects, total.connects / elapsed);
+    printf("  latency    mean %.1fus  p50 %lluus  p99 %lluus  p999 %lluus  max %lluus\n", total.hist.mean(),
+           (unsigned long long)total.hist.percentile(50), (unsigned long long)total.hist.percentile(99),
+           (unsigned long long)total.hist.percentile(99.9), (unsigned long long)total.hist.max());
+    return 0;
+}
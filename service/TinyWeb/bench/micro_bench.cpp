@@ -0,0 +1,579 @@
+/**
+ * @file micro_bench.cpp
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief 热点组件微基准
+            ===============
+            直接链接 server 的源码，对单个组件做可重复的隔离测量，每个用例输出一行 JSON，便于多次运行对比.
+            > * sort_timer_lst: 1k/10k/100k 定时器下的 add/adjust/tick
+            > * threadpool<T> 工作队列与 block_queue<T>: 1~64 线程吞吐
+            > * http_conn: 解析固定的请求报文
+            > * router: 路由表查找
+            > * Log::write_log: 每秒写入行数
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "../timer/lst_timer.h"
+#include "../threadpool/threadpool.h"
+#include "../log/block_queue.h"
+#include "../log/log.h"
+#include "../http/http_conn.h"
+#include "../http/router.h"
+
+using namespace std;
+
+static int g_repeat = 5;
+static const char *g_filter = nullptr;
+
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static bool selected(const char *name)
+{
+    return !g_filter || strstr(name, g_filter) != nullptr;
+}
+
+/**
+ * @brief 输出一个用例的结果: 多次重复取中位数与最小值
+ *
+ * @param name 用例名
+ * @param param 规模参数(定时器个数、线程数等)
+ * @param ops 每次重复的操作数
+ * @param samples 每次重复的耗时(ns)
+ */
+static void report(const char *name, long param, uint64_t ops, vector<uint64_t> &samples)
+{
+    sort(samples.begin(), samples.end());
+    uint64_t median = samples[samples.size() / 2];
+    uint64_t best = samples[0];
+    printf("{\"bench\":\"%s\",\"param\":%ld,\"ops\":%llu,\"repeat\":%zu,"
+           "\"median_ns_per_op\":%.2f,\"min_ns_per_op\":%.2f,\"ops_per_sec\":%.0f}\n",
+           name, param, (unsigned long long)ops, samples.size(),
+           (double)median / ops, (double)best / ops, ops * 1e9 / median);
+    fflush(stdout);
+}
+
+/*************************** sort_timer_lst ***************************/
+
+static void noop_cb(client_data *)
+{
+}
+
+static util_timer *make_timer(time_t expire)
+{
+    util_timer *t = new util_timer;
+    t->expire = expire;
+    t->cb_func = noop_cb;
+    t->user_data = nullptr;
+    return t;
+}
+
+/**
+ * @brief 按到期时间倒序插入，每次都落在表头，O(n) 构造出 n 个升序定时器
+ *
+ */
+static void fill_timers(sort_timer_lst &lst, vector<util_timer *> &timers, int n, time_t base)
+{
+    timers.resize(n);
+    for (int i = n - 1; i >= 0; --i)
+    {
+        timers[i] = make_timer(base + i);
+        lst.add_timer(timers[i]);
+    }
+}
+
+static int timer_ops(int n)
+{
+    int ops = 20000000 / n;
+    return max(200, min(10000, ops));
+}
+
+static void bench_timer(int n)
+{
+    time_t now = time(NULL);
+    int ops = timer_ops(n);
+
+    // add: 新连接的到期时间总是最晚的，需要遍历到表尾
+    if (selected("timer_add"))
+    {
+        vector<uint64_t> samples;
+        for (int r = 0; r < g_repeat; ++r)
+        {
+            sort_timer_lst lst;
+            vector<util_timer *> timers;
+            fill_timers(lst, timers, n, now + 1000);
+            vector<util_timer *> added(ops);
+            for (int i = 0; i < ops; ++i)
+            {
+                added[i] = make_timer(now + 1000 + n + i);
+            }
+            uint64_t begin = now_ns();
+            for (int i = 0; i < ops; ++i)
+            {
+                lst.add_timer(added[i]);
+            }
+            samples.push_back(now_ns() - begin);
+        }
+        report("timer_add", n, ops, samples);
+    }
+
+    // adjust: 活跃连接把到期时间推迟到最晚
+    if (selected("timer_adjust"))
+    {
+        vector<uint64_t> samples;
+        unsigned int seed = 12345;
+        for (int r = 0; r < g_repeat; ++r)
+        {
+            sort_timer_lst lst;
+            vector<util_timer *> timers;
+            fill_timers(lst, timers, n, now + 1000);
+            time_t latest = now + 1000 + n;
+            uint64_t begin = now_ns();
+            for (int i = 0; i < ops; ++i)
+            {
+                util_timer *t = timers[rand_r(&seed) % n];
+                t->expire = latest++;
+                lst.adjust_timer(t);
+            }
+            samples.push_back(now_ns() - begin);
+        }
+        report("timer_adjust", n, ops, samples);
+    }
+
+    // tick: 全部到期，测每个到期定时器的处理开销
+    if (selected("timer_tick"))
+    {
+        vector<uint64_t> samples;
+        for (int r = 0; r < g_repeat; ++r)
+        {
+            sort_timer_lst lst;
+            vector<util_timer *> timers;
+            fill_timers(lst, timers, n, now - n - 1);
+            uint64_t begin = now_ns();
+            lst.tick();
+            samples.push_back(now_ns() - begin);
+        }
+        report("timer_tick", n, n, samples);
+    }
+
+    // requeue: 全部到期但期间都有活动，tick 只按 last_active 续期不关闭
+    if (selected("timer_requeue"))
+    {
+        vector<uint64_t> samples;
+        for (int r = 0; r < g_repeat; ++r)
+        {
+            sort_timer_lst lst;
+            lst.set_idle(15);
+            vector<util_timer *> timers;
+            fill_timers(lst, timers, n, now - n - 1);
+            for (int i = 0; i < n; ++i)
+            {
+                timers[i]->last_active = now;
+            }
+            uint64_t begin = now_ns();
+            lst.tick();
+            samples.push_back(now_ns() - begin);
+        }
+        report("timer_requeue", n, n, samples);
+    }
+}
+
+/*************************** threadpool / block_queue ***************************/
+
+static atomic<uint64_t> g_done(0);
+
+/**
+ * @brief 满足 threadpool<T> 接口的空任务，只计数
+ *
+ */
+struct bench_task
+{
+    MYSQL *mysql;
+    int m_state;
+    int improv;
+    int timer_flag;
+
+    void process() { g_done.fetch_add(1, memory_order_relaxed); }
+    bool read_once() { return true; }
+    bool write() { return true; }
+};
+
+static void bench_threadpool(int threads)
+{
+    if (!selected("threadpool_queue"))
+    {
+        return;
+    }
+    const int ops = 200000;
+    // 工作线程是 detach 的且没有退出机制，线程池只能常驻
+    threadpool<bench_task> *pool = new threadpool<bench_task>(0, connection_pool::GetInstance(), threads);
+    bench_task task;
+    task.mysql = nullptr;
+    task.m_state = task.improv = task.timer_flag = 0;
+
+    vector<uint64_t> samples;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        g_done.store(0);
+        uint64_t begin = now_ns();
+        for (int i = 0; i < ops; ++i)
+        {
+            while (!pool->append_p(&task))
+            {
+                sched_yield();
+            }
+        }
+        while (g_done.load(memory_order_relaxed) < (uint64_t)ops)
+        {
+            sched_yield();
+        }
+        samples.push_back(now_ns() - begin);
+    }
+    report("threadpool_queue", threads, ops, samples);
+}
+
+struct queue_args
+{
+    block_queue<int> *queue;
+    int items;
+};
+
+static void *queue_producer(void *arg)
+{
+    queue_args *a = (queue_args *)arg;
+    for (int i = 0; i < a->items; ++i)
+    {
+        while (!a->queue->push(i))
+        {
+            sched_yield();
+        }
+    }
+    return nullptr;
+}
+
+static void *queue_consumer(void *arg)
+{
+    queue_args *a = (queue_args *)arg;
+    int item;
+    while (a->queue->pop(item) && item >= 0)
+    {
+    }
+    return nullptr;
+}
+
+static void bench_block_queue(int threads)
+{
+    if (!selected("block_queue"))
+    {
+        return;
+    }
+    const int ops = 200000;
+    vector<uint64_t> samples;
+    for (int r = 0; r < g_repeat; ++r)
+    {
+        block_queue<int> queue(1000);
+        queue_args args;
+        args.queue = &queue;
+        args.items = ops / threads;
+        vector<pthread_t> producers(threads), consumers(threads);
+
+        uint64_t begin = now_ns();
+        for (int i = 0; i < threads; ++i)
+        {
+            pthread_create(&consumers[i], nullptr, queue_consumer, &args);
+            pthread_create(&producers[i], nullptr, queue_producer, &args);
+        }
+        for (int i = 0; i < threads; ++i)
+        {
+            pthread_join(producers[i], nullptr);
+        }
+        for (int i = 0; i < threads; ++i)
+        {
+            while (!queue.push(-1))
+            {
+                sched_yield();
+            }
+        }
+        for (int i = 0; i < threads; ++i)
+        {
+            pthread_join(consumers[i], nullptr);
+        }
+        samples.push_back(now_ns() - begin);
+    }
+    report("block_queue", threads, (uint64_t)(ops / threads) * threads, samples);
+}
+
+/*************************** http_conn ***************************/
+
+/**
+ * @brief 通过友元访问 http_conn 的解析函数，只测报文解析，不包含 do_request 的文件操作
+ *
+ */
+class http_parse_bench
+{
+public:
+    static http_conn::HTTP_CODE parse(http_conn &conn, const char *req, int len)
+    {
+        conn.init();
+        conn.m_close_log = 1;
+        memcpy(conn.m_read_buf, req, len);
+        conn.m_read_idx = len;
+
+        http_conn::LINE_STATUS line_status = http_conn::LINE_OK;
+        http_conn::HTTP_CODE ret = http_conn::NO_REQUEST;
+        while ((conn.m_check_state == http_conn::CHECK_STATE_CONTENT && line_status == http_conn::LINE_OK) ||
+               (conn.m_check_state != http_conn::CHECK_STATE_CONTENT &&
+                (line_status = conn.parse_line()) == http_conn::LINE_OK))
+        {
+            char *text = conn.get_line();
+            conn.m_start_line = conn.m_checked_idx;
+            switch (conn.m_check_state)
+            {
+            case http_conn::CHECK_STATE_REQUESTLINE:
+                ret = conn.parse_request_line(text);
+                break;
+            case http_conn::CHECK_STATE_HEADER:
+                ret = conn.parse_headers(text);
+                break;
+            case http_conn::CHECK_STATE_CONTENT:
+                ret = conn.parse_content(text);
+                line_status = http_conn::LINE_OPEN;
+                break;
+            }
+            if (ret != http_conn::NO_REQUEST)
+            {
+                return ret;
+            }
+        }
+        return ret;
+    }
+};
+
+static void bench_parse()
+{
+    static const struct
+    {
+        const char *name;
+        const char *request;
+    } cases[] = {
+        {"parse_get_minimal",
+         "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n"},
+        {"parse_get_browser",
+         "GET /picture.html HTTP/1.1\r\n"
+         "Host: 127.0.0.1:9006\r\n"
+         "Connection: keep-alive\r\n"
+         "Cache-Control: max-age=0\r\n"
+         "Upgrade-Insecure-Requests: 1\r\n"
+         "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/118.0 Safari/537.36\r\n"
+         "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\n"
+         "Accept-Encoding: gzip, deflate, br\r\n"
+         "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8\r\n"
+         "If-None-Match: \"5e8a-2c4-61d2b7f0\"\r\n"
+         "If-Modified-Since: Wed, 29 Dec 2021 08:00:00 GMT\r\n"
+         "\r\n"},
+        {"parse_post_login",
+         "POST /2CGISQL.cgi HTTP/1.1\r\n"
+         "Host: 127.0.0.1:9006\r\n"
+         "Connection: keep-alive\r\n"
+         "Content-Type: application/x-www-form-urlencoded\r\n"
+         "Content-Length: 23\r\n"
+         "\r\n"
+         "user=bench&passwd=bench"},
+    };
+
+    http_conn *conn = new http_conn;
+    const int ops = 200000;
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c)
+    {
+        if (!selected(cases[c].name))
+        {
+            continue;
+        }
+        int len = strlen(cases[c].request);
+        if (http_parse_bench::parse(*conn, cases[c].request, len) != http_conn::GET_REQUEST)
+        {
+            fprintf(stderr, "%s: canned request did not parse\n", cases[c].name);
+            continue;
+        }
+        vector<uint64_t> samples;
+        for (int r = 0; r < g_repeat; ++r)
+        {
+            uint64_t begin = now_ns();
+            for (int i = 0; i < ops; ++i)
+            {
+                http_parse_bench::parse(*conn, cases[c].request, len);
+            }
+            samples.push_back(now_ns() - begin);
+        }
+        report(cases[c].name, len, ops, samples);
+    }
+    delete conn;
+}
+
+/*************************** router ***************************/
+
+static void bench_route()
+{
+    if (!selected("route_match"))
+    {
+        return;
+    }
+    http_conn::init_routes("/tmp");
+    //命中静态映射、命中处理函数、未命中各一
+    static const struct
+    {
+        http_conn::METHOD method;
+        const char *url;
+    } urls[] = {
+        {http_conn::GET, "/5"},
+        {http_conn::POST, "/2CGISQL.cgi"},
+        {http_conn::GET, "/picture.html"},
+    };
+    const int n = sizeof(urls) / sizeof(urls[0]);
+    const int ops = 3000000;
+    router *r = router::get_instance();
+    vector<uint64_t> samples;
+    uintptr_t sink = 0;
+    for (int rep = 0; rep < g_repeat; ++rep)
+    {
+        uint64_t begin = now_ns();
+        for (int i = 0; i < ops; ++i)
+        {
+            sink += (uintptr_t)r->match(urls[i % n].method, urls[i % n].url);
+        }
+        samples.push_back(now_ns() - begin);
+    }
+    if (sink == 1)
+    {
+        printf("\n");
+    }
+    report("route_match", n, ops, samples);
+}
+
+/*************************** Log ***************************/
+
+struct log_args
+{
+    int lines;
+};
+
+static void *log_writer(void *arg)
+{
+    log_args *a = (log_args *)arg;
+    int m_close_log = 0;
+    for (int i = 0; i < a->lines; ++i)
+    {
+        LOG_INFO("deal with the client(%s) fd %d", "127.0.0.1", i);
+    }
+    return nullptr;
+}
+
+static void bench_log(const char *dir, int async)
+{
+    if (!selected("log_write"))
+    {
+        return;
+    }
+    char path[256];
+    snprintf(path, sizeof(path), "%s/micro_bench_log", dir);
+    // 单例只能初始化一次，同步与异步需分两次运行(-l)
+    Log::get_instance()->init(path, 0, 2000, 800000, async ? 800 : 0);
+
+    const int ops = 100000;
+    const int thread_counts[] = {1, 4};
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); ++t)
+    {
+        int threads = thread_counts[t];
+        vector<uint64_t> samples;
+        for (int r = 0; r < g_repeat; ++r)
+        {
+            log_args args;
+            args.lines = ops / threads;
+            vector<pthread_t> tids(threads);
+            uint64_t begin = now_ns();
+            for (int i = 0; i < threads; ++i)
+            {
+                pthread_create(&tids[i], nullptr, log_writer, &args);
+            }
+            for (int i = 0; i < threads; ++i)
+            {
+                pthread_join(tids[i], nullptr);
+            }
+            samples.push_back(now_ns() - begin);
+        }
+        report(async ? "log_write_async" : "log_write_sync", threads, (uint64_t)(ops / threads) * threads, samples);
+    }
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-b name_filter] [-r repeat] [-l 0|1 (log sync/async)] [-o log_dir]\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+    int async_log = 0;
+    const char *log_dir = "/tmp";
+    int opt;
+    while ((opt = getopt(argc, argv, "b:r:l:o:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            g_filter = optarg;
+            break;
+        case 'r':
+            g_repeat = max(1, atoi(optarg));
+            break;
+        case 'l':
+            async_log = atoi(optarg);
+            break;
+        case 'o':
+            log_dir = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const int timer_sizes[] = {1000, 10000, 100000};
+    for (size_t i = 0; i < sizeof(timer_sizes) / sizeof(timer_sizes[0]); ++i)
+    {
+        bench_timer(timer_sizes[i]);
+    }
+
+    const int thread_counts[] = {1, 2, 4, 8, 16, 32, 64};
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); ++i)
+    {
+        bench_threadpool(thread_counts[i]);
+    }
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); ++i)
+    {
+        bench_block_queue(thread_counts[i]);
+    }
+
+    bench_parse();
+    bench_route();
+    bench_log(log_dir, async_log);
+    return 0;
+}
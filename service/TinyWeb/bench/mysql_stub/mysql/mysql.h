@@ -0,0 +1,57 @@
+/**
+ * @file mysql.h
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief 压测用的 libmysqlclient 替身
+            ===============
+            只实现 TinyWeb 用到的那一小部分 C API，数据保存在进程内存中，
+            使 server 可以脱离真实 MySQL 在本机上做端到端压测.
+            > * 通过 -Ibench/mysql_stub 覆盖系统的 <mysql/mysql.h>
+            > * 用户表初始数据来自环境变量 TINYWEB_STUB_USERS 指定的文件(每行 "用户名 密码")
+            > * 第 i 行的自增 id 为 i；支持 select f_username, F_passwd、按 id > N 读取(带 id 与 crc32 列)、
+                select count(*)(带 id <= N 时同时返回各行 crc32 的异或)与 INSERT ... VALUES('name', 'passwd'),
+                插入的行追加写回用户文件
+            > * mysql_real_escape_string 按 libmysqlclient 的规则转义,INSERT 解析时还原
+            > * 设置 TINYWEB_STUB_DELAY_MS 时每次插入等待相应毫秒数,模拟慢数据库
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __MYSQL_STUB_H__
+#define __MYSQL_STUB_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef char **MYSQL_ROW;
+
+typedef struct st_mysql_field
+{
+    char *name;
+} MYSQL_FIELD;
+
+typedef struct st_mysql_res MYSQL_RES;
+typedef struct st_mysql MYSQL;
+
+MYSQL *mysql_init(MYSQL *mysql);
+MYSQL *mysql_real_connect(MYSQL *mysql, const char *host, const char *user, const char *passwd,
+                          const char *db, unsigned int port, const char *unix_socket, unsigned long clientflag);
+int mysql_query(MYSQL *mysql, const char *q);
+unsigned long mysql_real_escape_string(MYSQL *mysql, char *to, const char *from, unsigned long length);
+MYSQL_RES *mysql_store_result(MYSQL *mysql);
+MYSQL_RES *mysql_use_result(MYSQL *mysql);
+unsigned int mysql_num_fields(MYSQL_RES *res);
+MYSQL_FIELD *mysql_fetch_field(MYSQL_RES *res);
+MYSQL_ROW mysql_fetch_row(MYSQL_RES *res);
+void mysql_free_result(MYSQL_RES *res);
+const char *mysql_error(MYSQL *mysql);
+void mysql_close(MYSQL *sock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MYSQL_STUB_H__ */
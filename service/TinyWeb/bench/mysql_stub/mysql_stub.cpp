@@ -0,0 +1,298 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <zlib.h>
+#include "mysql/mysql.h"
+
+using namespace std;
+
+struct st_mysql
+{
+    char error[128];
+    MYSQL_RES *pending; //最近一次 select 的结果,由 store/use_result 取走
+};
+
+struct st_mysql_res
+{
+    vector<vector<string> > rows;
+    unsigned int columns;
+    size_t cursor;
+    char *row[4];
+    MYSQL_FIELD fields[4];
+};
+
+//进程内的 t_user 表,所有"连接"共享,第 i 行的自增 id 为 i + 1
+static pthread_mutex_t g_table_lock = PTHREAD_MUTEX_INITIALIZER;
+static vector<pair<string, string> > g_table;
+static bool g_loaded = false;
+
+/**
+ * @brief 首次连接时从 TINYWEB_STUB_USERS 指定的文件加载初始用户
+ *
+ */
+static void load_table()
+{
+    if (g_loaded)
+    {
+        return;
+    }
+    g_loaded = true;
+    const char *path = getenv("TINYWEB_STUB_USERS");
+    if (!path)
+    {
+        return;
+    }
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+    {
+        return;
+    }
+    char name[100], passwd[100];
+    while (fscanf(fp, "%99s %99s", name, passwd) == 2)
+    {
+        g_table.push_back(make_pair(string(name), string(passwd)));
+    }
+    fclose(fp);
+}
+
+/**
+ * @brief 与 crc32(concat_ws(0x00, id, f_username, F_passwd)) 相同
+ *
+ */
+static unsigned long row_crc(size_t i)
+{
+    string s = to_string(i + 1);
+    s += '\0';
+    s += g_table[i].first;
+    s += '\0';
+    s += g_table[i].second;
+    return crc32(0, (const Bytef *)s.data(), s.size());
+}
+
+/**
+ * @brief 取出 VALUES('a', 'b') 中第 idx 个单引号字符串
+ *
+ */
+static bool quoted_value(const char *q, int idx, string &out)
+{
+    const char *p = strchr(q, '(');
+    p = p ? strchr(p + 1, '(') : nullptr;
+    if (!p)
+    {
+        return false;
+    }
+    for (int i = 0; i <= idx; ++i)
+    {
+        p = strchr(p, '\'');
+        if (!p)
+        {
+            return false;
+        }
+        //引号内的反斜杠转义由 mysql_real_escape_string 产生,在这里还原
+        string value;
+        for (++p; *p && *p != '\''; ++p)
+        {
+            if (*p == '\\' && p[1])
+            {
+                ++p;
+                value += *p == '0' ? '\0' : *p == 'n' ? '\n' : *p == 'r' ? '\r' : *p == 'Z' ? '\032' : *p;
+            }
+            else
+            {
+                value += *p;
+            }
+        }
+        if (!*p)
+        {
+            return false;
+        }
+        if (i == idx)
+        {
+            out = value;
+        }
+        ++p;
+    }
+    return true;
+}
+
+MYSQL *mysql_init(MYSQL *mysql)
+{
+    if (mysql)
+    {
+        return mysql;
+    }
+    MYSQL *conn = (MYSQL *)calloc(1, sizeof(MYSQL));
+    return conn;
+}
+
+MYSQL *mysql_real_connect(MYSQL *mysql, const char *, const char *, const char *,
+                          const char *, unsigned int, const char *, unsigned long)
+{
+    pthread_mutex_lock(&g_table_lock);
+    load_table();
+    pthread_mutex_unlock(&g_table_lock);
+    return mysql;
+}
+
+unsigned long mysql_real_escape_string(MYSQL *mysql, char *to, const char *from, unsigned long length)
+{
+    (void)mysql;
+    char *out = to;
+    for (unsigned long i = 0; i < length; ++i)
+    {
+        char c = from[i];
+        char esc = c == '\0' ? '0' : c == '\n' ? 'n' : c == '\r' ? 'r' : c == '\032' ? 'Z' : c == '\'' || c == '"' || c == '\\' ? c : 0;
+        if (esc)
+        {
+            *out++ = '\\';
+            c = esc;
+        }
+        *out++ = c;
+    }
+    *out = '\0';
+    return out - to;
+}
+
+int mysql_query(MYSQL *mysql, const char *q)
+{
+    q += strspn(q, " \t");
+    if (strncasecmp(q, "select", 6) == 0)
+    {
+        MYSQL_RES *res = new MYSQL_RES;
+        //只支持 where id <= N(与 count(*) 一起)和 where id > N(按 id 顺序)
+        const char *le = strcasestr(q, "id <= ");
+        const char *gt = strcasestr(q, "id > ");
+        pthread_mutex_lock(&g_table_lock);
+        if (strncasecmp(q + 6 + strspn(q + 6, " \t"), "count(*)", 8) == 0)
+        {
+            size_t n = le ? min<size_t>(strtoull(le + 6, NULL, 10), g_table.size()) : g_table.size();
+            unsigned long checksum = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                checksum ^= row_crc(i);
+            }
+            res->rows.push_back({to_string(n), to_string(checksum)});
+            res->columns = le ? 2 : 1;
+            res->fields[0].name = (char *)"count(*)";
+            res->fields[1].name = (char *)"checksum";
+        }
+        else if (gt)
+        {
+            size_t off = min<size_t>(strtoull(gt + 5, NULL, 10), g_table.size());
+            for (size_t i = off; i < g_table.size(); ++i)
+            {
+                res->rows.push_back({to_string(i + 1), g_table[i].first, g_table[i].second, to_string(row_crc(i))});
+            }
+            res->columns = 4;
+            res->fields[0].name = (char *)"id";
+            res->fields[1].name = (char *)"f_username";
+            res->fields[2].name = (char *)"F_passwd";
+            res->fields[3].name = (char *)"crc";
+        }
+        else
+        {
+            for (size_t i = 0; i < g_table.size(); ++i)
+            {
+                res->rows.push_back({g_table[i].first, g_table[i].second});
+            }
+            res->columns = 2;
+            res->fields[0].name = (char *)"f_username";
+            res->fields[1].name = (char *)"F_passwd";
+        }
+        pthread_mutex_unlock(&g_table_lock);
+        res->cursor = 0;
+        delete mysql->pending;
+        mysql->pending = res;
+        return 0;
+    }
+    if (strncasecmp(q, "insert", 6) == 0)
+    {
+        //模拟慢数据库: 每次插入等待 TINYWEB_STUB_DELAY_MS 毫秒
+        const char *delay = getenv("TINYWEB_STUB_DELAY_MS");
+        if (delay)
+        {
+            usleep(atoi(delay) * 1000);
+        }
+        string name, passwd;
+        if (!quoted_value(q, 0, name) || !quoted_value(q, 1, passwd))
+        {
+            snprintf(mysql->error, sizeof(mysql->error), "stub: malformed insert");
+            return 1;
+        }
+        pthread_mutex_lock(&g_table_lock);
+        g_table.push_back(make_pair(name, passwd));
+        //写回用户文件,重启后数据仍在,与真实数据库一致
+        const char *path = getenv("TINYWEB_STUB_USERS");
+        FILE *fp = path ? fopen(path, "a") : nullptr;
+        if (fp)
+        {
+            fprintf(fp, "%s %s\n", name.c_str(), passwd.c_str());
+            fclose(fp);
+        }
+        pthread_mutex_unlock(&g_table_lock);
+        return 0;
+    }
+    snprintf(mysql->error, sizeof(mysql->error), "stub: unsupported query");
+    return 1;
+}
+
+MYSQL_RES *mysql_store_result(MYSQL *mysql)
+{
+    MYSQL_RES *res = mysql->pending;
+    mysql->pending = nullptr;
+    return res;
+}
+
+MYSQL_RES *mysql_use_result(MYSQL *mysql)
+{
+    return mysql_store_result(mysql);
+}
+
+unsigned int mysql_num_fields(MYSQL_RES *res)
+{
+    return res ? res->columns : 0;
+}
+
+MYSQL_FIELD *mysql_fetch_field(MYSQL_RES *res)
+{
+    return res ? res->fields : nullptr;
+}
+
+MYSQL_ROW mysql_fetch_row(MYSQL_RES *res)
+{
+    if (!res || res->cursor >= res->rows.size())
+    {
+        return nullptr;
+    }
+    vector<string> &r = res->rows[res->cursor++];
+    for (size_t i = 0; i < r.size(); ++i)
+    {
+        res->row[i] = (char *)r[i].c_str();
+    }
+    return res->row;
+}
+
+void mysql_free_result(MYSQL_RES *res)
+{
+    delete res;
+}
+
+const char *mysql_error(MYSQL *mysql)
+{
+    return mysql ? mysql->error : "stub: no connection";
+}
+
+void mysql_close(MYSQL *sock)
+{
+    if (sock)
+    {
+        delete sock->pending;
+    }
+    free(sock);
+}
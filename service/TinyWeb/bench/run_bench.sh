@@ -0,0 +1,31 @@
+#!/bin/bash
+# 在本机启动链接 MySQL 替身的 server_bench，依次跑几组典型场景
+# 用法: sh ./bench/run_bench.sh [端口] [每组秒数]，需在 TinyWeb 目录下执行
+
+PORT=${1:-9096}
+DURATION=${2:-10}
+
+make DEBUG=0 bench || exit 1
+
+USERS=$(mktemp)
+echo "bench bench" > $USERS
+
+TINYWEB_STUB_USERS=$USERS ./server_bench -p $PORT -c 1 -t 8 &
+SERVER=$!
+sleep 1
+
+run() {
+    echo "== $*"
+    ./http_bench -p $PORT -d $DURATION "$@"
+}
+
+run -c 64 -k 1 -x 100:0:0
+run -c 64 -k 0 -x 100:0:0
+# 建连速率: 大量短连接只请求最小的页面
+run -c 512 -k 0 -x 100:0:0 -f fans.html
+run -c 64 -k 1 -x 90:9:1
+run -c 64 -k 1 -x 90:9:1 -r 20000
+
+kill $SERVER
+wait $SERVER 2>/dev/null
+rm -f $USERS
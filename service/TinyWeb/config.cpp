@@ -33,11 +33,53 @@ Config::Config(){
 
     //并发模型,默认是proactor
     actor_model = 0; 
+
+    // listen队列长度,默认1024(受net.core.somaxconn限制)
+    backlog = 1024;
+
+    //每次监听事件最多accept的连接数,默认64
+    accept_batch = 64;
+
+    // TCP_DEFER_ACCEPT,默认不使用
+    defer_accept = 0;
+
+    // I/O后端,默认epoll
+    io_backend = 0;
+
+    //工作队列长度,默认10000
+    queue_size = 10000;
+
+    //队列深度达到90%时暂停accept并对新请求回复503,回落到60%时恢复
+    high_water = 90;
+    low_water = 60;
+
+    //单个IP的并发连接数,默认不限制
+    ip_limit = 0;
+
+    //默认以gzip 6级预压缩文本类静态文件
+    compress_level = 6;
+
+    //每块4KB,读请求体的连接各占一块
+    body_chunks = 1024;
+
+    //默认不启用平滑重启
+    drain_timeout = 0;
+
+    //默认不使用用户表快照
+    snapshot = nullptr;
+
+    //访问数据库的请求默认每个数据库连接对应一个线程
+    blocking_threads = 0;
+    blocking_queue = 1024;
+}
+
+Config::~Config()
+{
 }
 
 void Config::parse_arg(int argc, char*argv[]){
     int opt;
-    const char *str = "p:l:m:o:s:t:c:a:";
+    const char *str = "p:l:m:o:s:t:c:a:b:n:d:i:q:H:L:u:z:B:g:S:T:Q:";
     while ((opt = getopt(argc, argv, str)) != -1)
     {
         switch (opt)
@@ -82,7 +124,78 @@ void Config::parse_arg(int argc, char*argv[]){
             actor_model = atoi(optarg);
             break;
         }
+        case 'b':
+        {
+            backlog = atoi(optarg);
+            break;
+        }
+        case 'n':
+        {
+            accept_batch = atoi(optarg);
+            break;
+        }
+        case 'd':
+        {
+            defer_accept = atoi(optarg);
+            break;
+        }
+        case 'i':
+        {
+            io_backend = atoi(optarg);
+            break;
+        }
+        case 'q':
+        {
+            queue_size = atoi(optarg);
+            break;
+        }
+        case 'H':
+        {
+            high_water = atoi(optarg);
+            break;
+        }
+        case 'L':
+        {
+            low_water = atoi(optarg);
+            break;
+        }
+        case 'u':
+        {
+            ip_limit = atoi(optarg);
+            break;
+        }
+        case 'z':
+        {
+            compress_level = atoi(optarg);
+            break;
+        }
+        case 'B':
+        {
+            body_chunks = atoi(optarg);
+            break;
+        }
+        case 'g':
+        {
+            drain_timeout = atoi(optarg);
+            break;
+        }
+        case 'S':
+        {
+            snapshot = optarg;
+            break;
+        }
+        case 'T':
+        {
+            blocking_threads = atoi(optarg);
+            break;
+        }
+        case 'Q':
+        {
+            blocking_queue = atoi(optarg);
+            break;
+        }
         default:
             break;
         }
     }
+}
@@ -41,6 +41,48 @@ public:
 
     //并发模型选择
     int actor_model;
+
+    // listen的全连接队列长度
+    int backlog;
+
+    //每次监听事件最多accept的连接数
+    int accept_batch;
+
+    // TCP_DEFER_ACCEPT秒数,0为不使用
+    int defer_accept;
+
+    // I/O后端,0为epoll,1为io_uring
+    int io_backend;
+
+    //工作队列长度
+    int queue_size;
+
+    //过载高水位,工作队列长度的百分比
+    int high_water;
+
+    //过载恢复的低水位,工作队列长度的百分比
+    int low_water;
+
+    //单个客户端IP的最大并发连接数,0为不限制
+    int ip_limit;
+
+    //静态文件预压缩的gzip级别,0为不压缩
+    int compress_level;
+
+    //请求体缓冲块池的块数上限
+    int body_chunks;
+
+    //平滑重启时排空旧连接的最长秒数,0为不启用
+    int drain_timeout;
+
+    //用户表快照文件,为空时启动读取整张表
+    const char *snapshot;
+
+    //阻塞线程池的线程数,0为与数据库连接数相同
+    int blocking_threads;
+
+    //阻塞线程池的队列长度
+    int blocking_queue;
 };
 
 #endif //
\ No newline at end of file
@@ -0,0 +1,372 @@
+#include <sys/eventfd.h> // for eventfd 工作线程唤醒事件循环
+#include "coro_loop.h"
+#include "../webserver.h"
+
+coro_loop *coro_loop::s_loop = nullptr;
+locker coro_loop::s_done_lock;
+std::vector<std::pair<int, unsigned> > coro_loop::s_done;
+
+#ifdef TINYWEB_CORO
+#include <coroutine> // C++20 协程
+
+/**
+ * @brief 协程帧池
+          帧大小按64字节分级，释放的帧挂回对应的空闲链表，连接数稳定后不再调用operator new
+ *
+ */
+class frame_pool
+{
+public:
+    static const size_t GRAIN = 64;
+    static const size_t CLASSES = 16; //超过1KB的帧直接向系统申请
+
+    static void *alloc(size_t size)
+    {
+        size_t c = (size + GRAIN - 1) / GRAIN;
+        if (c > CLASSES)
+        {
+            return ::operator new(size);
+        }
+        node *n = s_free[c - 1];
+        if (n)
+        {
+            s_free[c - 1] = n->next;
+            return n;
+        }
+        return ::operator new(c * GRAIN);
+    }
+
+    static void release(void *p, size_t size)
+    {
+        size_t c = (size + GRAIN - 1) / GRAIN;
+        if (c > CLASSES)
+        {
+            ::operator delete(p);
+            return;
+        }
+        node *n = (node *)p;
+        n->next = s_free[c - 1];
+        s_free[c - 1] = n;
+    }
+
+private:
+    struct node
+    {
+        node *next;
+    };
+    static node *s_free[CLASSES];
+};
+
+frame_pool::node *frame_pool::s_free[frame_pool::CLASSES];
+
+/**
+ * @brief 连接协程的返回类型
+          协程创建后立即运行，结束时自动释放帧；挂起期间的帧由coro_slot持有
+ *
+ */
+struct conn_task
+{
+    struct promise_type
+    {
+        conn_task get_return_object() { return conn_task(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { abort(); }
+
+        static void *operator new(size_t size) { return frame_pool::alloc(size); }
+        static void operator delete(void *p, size_t size) { frame_pool::release(p, size); }
+    };
+};
+
+//事件循环侧的连接状态，与http_conn按fd一一对应
+struct coro_slot
+{
+    std::coroutine_handle<> handle; //挂起的协程，运行中或已结束时为空
+    bool offloaded;                 //正在等待线程池执行处理函数，期间不响应fd事件
+};
+
+/**
+ * @brief 等待fd可读或可写
+          事件已由http_conn::init/write或协程自己以EPOLLONESHOT注册，这里只登记句柄
+ *
+ */
+struct fd_awaiter
+{
+    coro_slot &slot;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) noexcept { slot.handle = h; }
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief 把需要数据库连接的处理函数交给阻塞线程池
+          队列已满时不挂起，co_await的结果为false
+ *
+ */
+struct offload_awaiter
+{
+    coro_slot &slot;
+    http_conn &conn;
+    bool accepted;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> h)
+    {
+        //先登记句柄，工作线程可能在defer返回前就已完成
+        slot.handle = h;
+        slot.offloaded = true;
+        accepted = conn.defer();
+        if (!accepted)
+        {
+            slot.handle = nullptr;
+            slot.offloaded = false;
+        }
+        return accepted;
+    }
+    bool await_resume() const noexcept { return accepted; }
+};
+
+class coro_session
+{
+public:
+    static conn_task serve(coro_loop *loop, int fd);
+};
+
+/**
+ * @brief 一个连接的完整处理过程，与process()/write()的状态转移一致
+ *
+ * @param loop
+ * @param fd
+ * @return conn_task
+ */
+conn_task coro_session::serve(coro_loop *loop, int fd)
+{
+    WebServer *server = loop->m_server;
+    http_conn &conn = server->users[fd];
+    coro_slot &slot = loop->m_slots[fd];
+
+    while (true)
+    {
+        //可读事件已由init或上一个响应发送完时注册
+        co_await fd_awaiter{slot};
+        if (!conn.read_once())
+        {
+            break;
+        }
+        util_timer *timer = server->users_timer[fd].timer;
+        if (timer)
+        {
+            server->adjust_timer(timer);
+        }
+
+        http_conn::HTTP_CODE ret = conn.process_read();
+        if (ret == http_conn::NO_REQUEST)
+        {
+            server->utils.modfd(http_conn::m_epollfd, fd, EPOLLIN, conn.m_TRIGMode);
+            continue;
+        }
+        if (ret == http_conn::DEFERRED_REQUEST)
+        {
+            //阻塞线程池的队列已满时回复503
+            bool accepted = co_await offload_awaiter{slot, conn, false};
+            ret = accepted ? conn.m_deferred_ret : http_conn::SERVICE_UNAVAILABLE;
+        }
+        if (!conn.process_write(ret))
+        {
+            break;
+        }
+
+        //直接在事件循环线程中发送，发不完时write已注册EPOLLOUT；
+        //发送完毕后长连接由write重置并注册EPOLLIN，否则返回false
+        bool alive;
+        while ((alive = conn.write()) && conn.bytes_to_send > 0)
+        {
+            co_await fd_awaiter{slot};
+        }
+        if (!alive)
+        {
+            break;
+        }
+    }
+
+    //协程正在运行，drop不会销毁本帧；连接已被定时器关闭时协程帧已随之销毁，不会运行到这里
+    server->deal_timer(server->users_timer[fd].timer, fd);
+}
+
+coro_loop::coro_loop(WebServer *server) : m_server(server), m_slots(nullptr), m_notify_fd(-1)
+{
+    m_close_log = server->m_close_log;
+}
+
+coro_loop::~coro_loop()
+{
+    if (s_loop == this)
+    {
+        http_conn::m_deferred_hook = nullptr;
+        Utils::u_drop_hook = nullptr;
+        s_loop = nullptr;
+    }
+    if (m_slots)
+    {
+        for (int i = 0; i < MAX_FD; ++i)
+        {
+            if (m_slots[i].handle)
+            {
+                m_slots[i].handle.destroy();
+            }
+        }
+        delete[] m_slots;
+    }
+    if (m_notify_fd >= 0)
+    {
+        close(m_notify_fd);
+    }
+}
+
+bool coro_loop::init()
+{
+    m_notify_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_notify_fd < 0)
+    {
+        return false;
+    }
+    m_slots = new coro_slot[MAX_FD];
+    for (int i = 0; i < MAX_FD; ++i)
+    {
+        m_slots[i].handle = nullptr;
+        m_slots[i].offloaded = false;
+    }
+    m_server->utils.addfd(http_conn::m_epollfd, m_notify_fd, false, 0);
+
+    s_loop = this;
+    http_conn::m_deferred_hook = deferred_hook;
+    Utils::u_drop_hook = drop_hook;
+    return true;
+}
+
+void coro_loop::start(int fd)
+{
+    //上一个使用该fd的连接由定时器关闭时，其帧仍挂起在槽位中
+    drop(fd);
+    coro_session::serve(this, fd);
+}
+
+void coro_loop::resume(int fd)
+{
+    coro_slot &slot = m_slots[fd];
+    if (!slot.handle || slot.offloaded)
+    {
+        return;
+    }
+    std::coroutine_handle<> h = slot.handle;
+    slot.handle = nullptr;
+    h.resume();
+}
+
+void coro_loop::drop(int fd)
+{
+    coro_slot &slot = m_slots[fd];
+    if (slot.handle)
+    {
+        slot.handle.destroy();
+        slot.handle = nullptr;
+    }
+    //处理函数稍后完成时不再恢复
+    slot.offloaded = false;
+}
+
+void coro_loop::complete()
+{
+    uint64_t val;
+    while (read(m_notify_fd, &val, sizeof(val)) > 0)
+    {
+    }
+
+    std::vector<std::pair<int, unsigned> > done;
+    s_done_lock.lock();
+    done.swap(s_done);
+    s_done_lock.unlock();
+
+    for (size_t i = 0; i < done.size(); ++i)
+    {
+        int fd = done[i].first;
+        coro_slot &slot = m_slots[fd];
+        //连接已关闭或fd已被新连接复用时不恢复
+        if (!slot.offloaded || !slot.handle || m_server->users[fd].m_conn_gen != done[i].second)
+        {
+            continue;
+        }
+        std::coroutine_handle<> h = slot.handle;
+        slot.handle = nullptr;
+        slot.offloaded = false;
+        h.resume();
+    }
+}
+
+void coro_loop::deferred_hook(http_conn *conn)
+{
+    coro_loop *loop = s_loop;
+    if (!loop)
+    {
+        return;
+    }
+    s_done_lock.lock();
+    s_done.push_back(std::make_pair(conn->m_sockfd, conn->m_deferred_gen));
+    s_done_lock.unlock();
+    uint64_t one = 1;
+    ssize_t n = write(loop->m_notify_fd, &one, sizeof(one));
+    (void)n;
+}
+
+void coro_loop::drop_hook(int fd)
+{
+    if (s_loop)
+    {
+        s_loop->drop(fd);
+    }
+}
+
+#else
+
+//未以CORO=1编译: init失败，WebServer不会使用协程引擎
+coro_loop::coro_loop(WebServer *server) : m_server(server), m_slots(nullptr), m_notify_fd(-1)
+{
+    m_close_log = server->m_close_log;
+}
+
+coro_loop::~coro_loop()
+{
+}
+
+bool coro_loop::init()
+{
+    return false;
+}
+
+void coro_loop::start(int)
+{
+}
+
+void coro_loop::resume(int)
+{
+}
+
+void coro_loop::drop(int)
+{
+}
+
+void coro_loop::complete()
+{
+}
+
+void coro_loop::deferred_hook(http_conn *)
+{
+}
+
+void coro_loop::drop_hook(int)
+{
+}
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * @file coro_loop.h
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief 基于C++20协程的连接引擎
+            ===============
+            可选的连接处理方式(-a 2，需以CORO=1编译)，每个连接对应一个协程，在事件循环线程中按顺序读请求、解析、发送响应.
+            > * 协程co_await可读/可写事件，事件仍由http_conn注册的EPOLLONESHOT产生，就绪时由事件循环恢复
+            > * 解析与响应复用http_conn的process_read/do_request/process_write/write，短请求不再经过工作队列
+            > * 需要数据库连接的处理函数(注册)交给阻塞线程池执行，完成后经eventfd回到事件循环线程继续
+            > * 协程帧从按大小分级的空闲链表分配，只在事件循环线程中分配与释放，无需加锁
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __CORO_LOOP_H__
+#define __CORO_LOOP_H__
+#include <vector>           // stl vector容器
+#include "../lock/locker.h" //自定义 线程同步机制包装类
+
+class WebServer;
+class http_conn;
+struct coro_slot;
+
+class coro_loop
+{
+public:
+    coro_loop(WebServer *server);
+    ~coro_loop();
+
+    /**
+     * @brief 创建通知用的eventfd并加入epoll，未以CORO=1编译时返回false由调用方退回线程池处理
+     *
+     * @return true
+     * @return false
+     */
+    bool init();
+    int notify_fd() const { return m_notify_fd; }
+
+    //为新连接启动协程，协程一直运行到连接关闭
+    void start(int fd);
+    //fd上的事件就绪，恢复等待它的协程
+    void resume(int fd);
+    //连接被定时器或对端关闭，销毁挂起的协程帧
+    void drop(int fd);
+    //恢复交给阻塞线程池的处理函数已完成的协程
+    void complete();
+
+    /**
+     * @brief http_conn::m_deferred_hook 的实现，在阻塞线程池中调用
+     *
+     * @param conn
+     */
+    static void deferred_hook(http_conn *conn);
+    //Utils::u_drop_hook 的实现，定时器关闭连接时销毁挂起的协程帧
+    static void drop_hook(int fd);
+
+private:
+    friend class coro_session;
+
+    WebServer *m_server;
+    coro_slot *m_slots; //按fd索引
+    int m_notify_fd;
+    int m_close_log;
+
+    static coro_loop *s_loop;
+    static locker s_done_lock;
+    static std::vector<std::pair<int, unsigned> > s_done; //处理函数已完成的连接(fd, 交出时的连接代数)
+};
+
+#endif /* __CORO_LOOP_H__ */
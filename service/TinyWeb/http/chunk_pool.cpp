@@ -0,0 +1,51 @@
+#include "chunk_pool.h"
+
+chunk_pool::chunk_pool() : m_total(0), m_max(1024)
+{
+}
+
+chunk_pool::~chunk_pool()
+{
+    for (size_t i = 0; i < m_free.size(); ++i)
+    {
+        delete[] m_free[i];
+    }
+}
+
+void chunk_pool::init(int max_chunks)
+{
+    if (max_chunks > 0)
+    {
+        m_max = max_chunks;
+    }
+}
+
+char *chunk_pool::get()
+{
+    m_lock.lock();
+    char *chunk = nullptr;
+    if (!m_free.empty())
+    {
+        chunk = m_free.back();
+        m_free.pop_back();
+    }
+    else if (m_total < m_max)
+    {
+        //按需分配,空闲块不归还系统
+        chunk = new char[CHUNK_SIZE];
+        ++m_total;
+    }
+    m_lock.unlock();
+    return chunk;
+}
+
+void chunk_pool::put(char *chunk)
+{
+    if (!chunk)
+    {
+        return;
+    }
+    m_lock.lock();
+    m_free.push_back(chunk);
+    m_lock.unlock();
+}
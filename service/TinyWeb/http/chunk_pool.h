@@ -0,0 +1,47 @@
+/**
+ * @file chunk_pool.h
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief 请求体缓冲块池
+            ===============
+            请求体不再要求整体装进读缓冲区,解码后的数据按固定大小的块交给处理函数,连接读请求体期间只占用一个块.
+            > * 块大小固定,用完归还到空闲链表复用
+            > * 池中块的总数有上限,用尽时get返回nullptr,由调用方拒绝请求
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __CHUNK_POOL_H__
+#define __CHUNK_POOL_H__
+#include <vector>
+#include "../lock/locker.h"
+
+class chunk_pool
+{
+public:
+    static const int CHUNK_SIZE = 4096;
+
+    static chunk_pool *get_instance()
+    {
+        static chunk_pool instance;
+        return &instance;
+    }
+
+    //设置块总数上限,需在开始服务前调用
+    void init(int max_chunks);
+    char *get();
+    void put(char *chunk);
+
+private:
+    chunk_pool();
+    ~chunk_pool();
+
+private:
+    locker m_lock;
+    std::vector<char *> m_free; //空闲块
+    int m_total;                //已分配的块数
+    int m_max;                  //块总数上限
+};
+
+#endif /* __CHUNK_POOL_H__ */
@@ -1,53 +1,229 @@
 #include "http_conn.h"
+#include "precompress.h"
+#include "chunk_pool.h"
+#include "router.h"
+#include "../CGImysql/user_snapshot.h"
 #include <mysql/mysql.h>
 #include <fstream>
+#include <sys/sendfile.h>
 Utils util;
 //定义http响应的一些状态信息
 const char *ok_200_title = "OK";
+const char *partial_206_title = "Partial Content";
+const char *not_modified_304_title = "Not Modified";
+const char *error_416_title = "Range Not Satisfiable";
 const char *error_400_title = "Bad Request";
 const char *error_400_form = "Your request has bad syntax or is inherently impossible to staisfy.\n";
 const char *error_403_title = "Forbidden";
 const char *error_403_form = "You do not have permission to get file form this server.\n";
 const char *error_404_title = "Not Found";
 const char *error_404_form = "The requested file was not found on this server.\n";
+const char *error_413_title = "Payload Too Large";
+const char *error_413_form = "The request body is larger than the server is willing to process.\n";
 const char *error_500_title = "Internal Error";
 const char *error_500_form = "There was an unusual problem serving the request file.\n";
+const char *error_503_title = "Service Unavailable";
+const char *error_503_form = "The server is too busy to handle the request.\n";
 
 locker m_lock; //互斥锁
-map<string, string> users;
+map<string, string> users;        //快照之外的用户: 尚未写入快照的行与运行期间注册的用户,未启用快照时为整张表
+user_snapshot users_snapshot;     //启动时映射的用户表快照
 
-void http_conn::initmysql_result(connection_pool *connPool)
+/**
+ * @brief 核对快照: 数据库中id不超过max_id的行数与校验和都与快照一致,才说明这些行没有被修改、删除
+ *
+ */
+static bool snapshot_current(MYSQL *mysql, const user_table_mark &mark)
+{
+    char sql[256];
+    snprintf(sql, sizeof(sql), "select count(*), coalesce(bit_xor(crc32(concat_ws(0x00, id, f_username, F_passwd))), 0) "
+                               "from tinyweb.t_user where id <= %llu",
+             (unsigned long long)mark.max_id);
+    if (mysql_query(mysql, sql))
+    {
+        return false;
+    }
+    MYSQL_RES *result = mysql_store_result(mysql);
+    MYSQL_ROW row = mysql_fetch_row(result);
+    bool same = row && row[0] && row[1] && strtoull(row[0], NULL, 10) == mark.rows &&
+                strtoull(row[1], NULL, 10) == mark.checksum;
+    mysql_free_result(result);
+    return same;
+}
+
+/**
+ * @brief 按id顺序读取id大于mark.max_id的行存入out,同时推进mark
+          结果集用mysql_use_result逐行读取,不在客户端缓存整个结果集
+ *
+ * @return 读到的行数,查询失败时返回-1
+ */
+static long long fetch_users(MYSQL *mysql, user_table_mark &mark, map<string, string> &out)
 {
+    char sql[256];
+    snprintf(sql, sizeof(sql), "select id, f_username, F_passwd, crc32(concat_ws(0x00, id, f_username, F_passwd)) "
+                               "from tinyweb.t_user where id > %llu order by id",
+             (unsigned long long)mark.max_id);
+    if (mysql_query(mysql, sql))
+    {
+        return -1;
+    }
+    MYSQL_RES *result = mysql_use_result(mysql);
+    long long fetched = 0;
+    while (MYSQL_ROW row = mysql_fetch_row(result))
+    {
+        out[row[1] ? row[1] : ""] = row[2] ? row[2] : "";
+        mark.max_id = strtoull(row[0], NULL, 10);
+        ++mark.rows;
+        mark.checksum ^= strtoull(row[3], NULL, 10);
+        ++fetched;
+    }
+    mysql_free_result(result);
+    return fetched;
+}
+
+/**
+ * @brief 加载用户表
+          启用快照时先映射快照并核对,再只从数据库读取快照之后新增的行;否则读取整张表.
+          要求user表有自增主键id
+ *
+ * @param connPool
+ * @param close_log 此时连接尚未init,日志开关由调用方传入
+ * @param snapshot 快照文件路径,nullptr为不使用
+ */
+void http_conn::initmysql_result(connection_pool *connPool, int close_log, const char *snapshot)
+{
+    m_close_log = close_log;
+
     //先从连接池中取出一个连接
     MYSQL *mysql = nullptr;
     connectionRAII mysqlcon(&mysql, connPool);
 
+    if (snapshot && users_snapshot.open(snapshot) && !snapshot_current(mysql, users_snapshot.mark()))
+    {
+        LOG_WARN("user snapshot %s is stale, reload", snapshot);
+        users_snapshot.close();
+    }
+
     //在user表中搜索username,passwd数据，浏览器输入
-    if (mysql_query(mysql, "select f_username, F_passwd from tinyweb.t_user"))
+    user_table_mark mark = users_snapshot.mark();
+    long long fetched = fetch_users(mysql, mark, users);
+    if (fetched < 0)
     {
         LOG_ERROR("select error：%s\n", mysql_error(mysql));
+        return;
     }
+    LOG_INFO("user table: %u from snapshot, %lld rows from database", users_snapshot.count(), fetched);
 
-    //从表中搜索完整的结果集
-    MYSQL_RES *result = mysql_store_result(mysql);
+    //首次启动或追加较多时立即写出快照,map中只留启动后新增的用户
+    if (snapshot && fetched > 0 && !save_users(snapshot, users, mark, true))
+    {
+        LOG_ERROR("write user snapshot %s failed", snapshot);
+    }
+}
 
-    //返回结果集中的列数
-    int num_fields = mysql_num_fields(result);
+/**
+ * @brief 退出前把快照之后新增的行并入快照
+          运行期间注册的用户不知道id,不直接写入,而是和其他进程新增的行一起从数据库按id读取
+ *
+ * @param connPool
+ * @param snapshot
+ * @return false 查询或写文件失败
+ */
+bool http_conn::save_users(connection_pool *connPool, const char *snapshot)
+{
+    MYSQL *mysql = nullptr;
+    connectionRAII mysqlcon(&mysql, connPool);
+    map<string, string> fresh;
+    user_table_mark mark = users_snapshot.mark();
+    long long fetched = fetch_users(mysql, mark, fresh);
+    if (fetched < 0)
+    {
+        return false;
+    }
+    return fetched == 0 || save_users(snapshot, fresh, mark, false);
+}
 
-    //返回所有字段结构的数组
-    MYSQL_FIELD *fields = mysql_fetch_field(result);
+/**
+ * @brief 把快照与delta归并写入快照文件
+ *
+ * @param snapshot
+ * @param delta 须恰好是快照之后、直到mark的行
+ * @param mark 归并结果对应的数据库状态
+ * @param reload 写完后重新映射快照并清空users,只能在工作线程启动前使用
+ * @return false 写文件失败
+ */
+bool http_conn::save_users(const char *snapshot, const map<string, string> &delta, const user_table_mark &mark, bool reload)
+{
+    m_lock.lock();
+    bool ok = user_snapshot::write(snapshot, users_snapshot.count() ? &users_snapshot : nullptr, delta, mark);
+    if (ok && reload && users_snapshot.open(snapshot))
+    {
+        users.clear();
+    }
+    m_lock.unlock();
+    return ok;
+}
 
-    //从结果集中获取下一行，将对应的用户名和密码，存入map中
-    while (MYSQL_ROW row = mysql_fetch_row(result))
+/**
+ * @brief 查找用户的密码,先查启动后新增的用户,再查快照
+ *
+ */
+static const char *find_user(const char *name)
+{
+    map<string, string>::iterator it = users.find(name);
+    if (it != users.end())
     {
-        string temp1(row[0]);
-        string temp2(row[1]);
-        users[temp1] = temp2;
+        return it->second.c_str();
     }
+    return users_snapshot.find(name);
 }
 
 int http_conn::m_user_count = 0;
 int http_conn::m_epollfd = -1;
+int http_conn::m_ip_limit = 0;
+bool http_conn::m_draining = false;
+threadpool<http_conn> *http_conn::m_blocking_pool = nullptr;
+void (*http_conn::m_deferred_hook)(http_conn *conn) = nullptr;
+
+//连接可能在工作线程中关闭,计数表需加锁
+static locker m_ip_lock;
+static map<in_addr_t, int> m_ip_conns;
+
+bool http_conn::acquire_ip(in_addr_t ip)
+{
+    if (m_ip_limit <= 0)
+    {
+        return true;
+    }
+    m_ip_lock.lock();
+    int &count = m_ip_conns[ip];
+    bool ok = count < m_ip_limit;
+    if (ok)
+    {
+        ++count;
+    }
+    else if (0 == count)
+    {
+        m_ip_conns.erase(ip);
+    }
+    m_ip_lock.unlock();
+    return ok;
+}
+
+void http_conn::release_ip(in_addr_t ip)
+{
+    if (m_ip_limit <= 0)
+    {
+        return;
+    }
+    m_ip_lock.lock();
+    map<in_addr_t, int>::iterator it = m_ip_conns.find(ip);
+    if (it != m_ip_conns.end() && --it->second <= 0)
+    {
+        m_ip_conns.erase(it);
+    }
+    m_ip_lock.unlock();
+}
 
 /**
  * @brief 关闭连接，关闭一个连接，客户总量减一
@@ -56,12 +232,14 @@ int http_conn::m_epollfd = -1;
  */
 void http_conn::close_conn(bool real_close)
 {
+    release_body();
     if (real_close && (m_sockfd != -1))
     {
         LOG_INFO("close fd(%d) connection\n", m_sockfd);
         util.removefd(m_epollfd, m_sockfd);
         m_sockfd = -1;
         m_user_count--;
+        release_ip(m_address.sin_addr.s_addr);
     }
 }
 
@@ -80,10 +258,14 @@ void http_conn::close_conn(bool real_close)
 void http_conn::init(int sockfd, const sockaddr_in &addr, char *root, int TRIGMode,
                      int close_log, string user, string passwd, string sqlname)
 {
+    ++m_conn_gen;
     m_sockfd = sockfd;
     m_address = addr;
+    //上一个使用该槽位的连接可能在发送中途被关闭
+    unmap();
 
-    util.addfd(m_epollfd, sockfd, true, m_TRIGMode);
+    // connfd由accept4(SOCK_NONBLOCK)创建,无需再设置非阻塞
+    util.addfd(m_epollfd, sockfd, true, TRIGMode, false);
     m_user_count++;
 
     //当浏览器出现连接重置时，可能是网站根目录出错或http响应格式出错或者访问的文件中内容完全为空
@@ -92,7 +274,7 @@ void http_conn::init(int sockfd, const sockaddr_in &addr, char *root, int TRIGMo
     m_close_log = close_log;
 
     strcpy(sql_user, user.c_str());
-    strcpy(sql_passwd, pass.c_str());
+    strcpy(sql_passwd, passwd.c_str());
     strcpy(sql_name, sqlname.c_str());
 
     init();
@@ -115,12 +297,36 @@ void http_conn::init()
     m_version = 0;
     m_content_length = 0;
     m_host = 0;
+    m_accept_encoding = 0;
+    m_content_encoding = nullptr;
+    m_vary = false;
+    m_body = 0;
+    m_body_len = 0;
+    m_if_none_match = 0;
+    m_if_modified_since = 0;
+    m_etag[0] = '\0';
+    m_last_modified[0] = '\0';
+    m_range = 0;
+    m_if_range = 0;
+    m_range_start = 0;
+    m_range_total = 0;
+    m_file_off = 0;
+    m_string = 0;
+    m_chunked = false;
+    m_body_state = BODY_DATA;
+    m_body_left = 0;
+    m_body_fill = 0;
+    m_body_too_large = false;
+    m_on_body = nullptr;
+    m_body_total = 0;
+    release_body();
     m_start_line = 0;
     m_checked_idx = 0;
     m_read_idx = 0;
     m_write_idx = 0;
     cgi = 0;
     m_state = 0;
+    m_deferred = false;
     timer_flag = 0;
     improv = 0;
 
@@ -197,12 +403,13 @@ bool http_conn::read_once()
     }
     else // ET读取
     {
-        while (true)
+        //读缓冲区满时先交给process_read取走请求体,重新注册EPOLLIN后剩余数据会再次触发
+        while (m_read_idx < READ_BUFFER_SIZE)
         {
             bytes_read = recv(m_sockfd, m_read_buf + m_read_idx, READ_BUFFER_SIZE - m_read_idx, 0);
             if (bytes_read == -1)
             {
-                if (errno == EAGAIN || error == EWOULDBLOCK)
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
                 {
                     break;
                 }
@@ -214,6 +421,7 @@ bool http_conn::read_once()
             }
             m_read_idx += bytes_read;
         }
+        return true;
     }
 }
 
@@ -225,7 +433,7 @@ bool http_conn::read_once()
  */
 http_conn::HTTP_CODE http_conn::parse_request_line(char *text)
 {
-    m_url = strpbrk(text, "\t");
+    m_url = strpbrk(text, " \t");
     if (!m_url)
     {
         return BAD_REQUEST;
@@ -247,7 +455,7 @@ http_conn::HTTP_CODE http_conn::parse_request_line(char *text)
     }
 
     m_url += strspn(m_url, " \t");
-    m_version += strspn(m_url, " \t");
+    m_version = strpbrk(m_url, " \t");
     if (!m_version)
     {
         return BAD_REQUEST;
@@ -278,7 +486,7 @@ http_conn::HTTP_CODE http_conn::parse_request_line(char *text)
     }
     if (strlen(m_url) == 1)
     {
-        strcat(m_ur, "judge.html");
+        strcat(m_url, "judge.html");
     }
     m_check_state = CHECK_STATE_HEADER;
     return NO_REQUEST;
@@ -293,11 +501,30 @@ http_conn::HTTP_CODE http_conn::parse_headers(char *text)
 {
     if (text[0] == '\0')
     {
+        //请求头读完即可确定路由,流式路由的请求体边读边交给处理函数
+        const router::route *route = router::get_instance()->match(m_method, m_url);
+        m_on_body = route ? route->on_body : nullptr;
+        //两者同时出现时以chunked为准
+        if (m_chunked)
+        {
+            m_body_state = BODY_SIZE;
+            m_check_state = CHECK_STATE_CONTENT;
+            return NO_REQUEST;
+        }
         if (m_content_length != 0)
         {
+            //长度已知时不必读取请求体就能拒绝
+            if (!m_on_body && m_content_length > chunk_pool::CHUNK_SIZE - 1)
+            {
+                m_body_too_large = true;
+                return PAYLOAD_TOO_LARGE;
+            }
+            m_body_state = BODY_DATA;
+            m_body_left = m_content_length;
             m_check_state = CHECK_STATE_CONTENT;
             return NO_REQUEST;
         }
+        return GET_REQUEST;
     }
     else if (strncasecmp(text, "Connection:", 11) == 0)
     {
@@ -313,6 +540,20 @@ http_conn::HTTP_CODE http_conn::parse_headers(char *text)
         text += 15;
         text += strspn(text, " \t");
         m_content_length = atol(text);
+        if (m_content_length < 0)
+        {
+            return BAD_REQUEST;
+        }
+    }
+    else if (strncasecmp(text, "Transfer-Encoding:", 18) == 0)
+    {
+        text += 18;
+        text += strspn(text, " \t");
+        if (strcasecmp(text, "chunked") != 0)
+        {
+            return BAD_REQUEST;
+        }
+        m_chunked = true;
     }
     else if (strncasecmp(text, "Host:", 5) == 0)
     {
@@ -320,6 +561,36 @@ http_conn::HTTP_CODE http_conn::parse_headers(char *text)
         text += strspn(text, " \t");
         m_host = text;
     }
+    else if (strncasecmp(text, "Accept-Encoding:", 16) == 0)
+    {
+        text += 16;
+        text += strspn(text, " \t");
+        m_accept_encoding = precompress::parse_accept(text);
+    }
+    else if (strncasecmp(text, "If-None-Match:", 14) == 0)
+    {
+        text += 14;
+        text += strspn(text, " \t");
+        m_if_none_match = text;
+    }
+    else if (strncasecmp(text, "If-Modified-Since:", 18) == 0)
+    {
+        text += 18;
+        text += strspn(text, " \t");
+        m_if_modified_since = text;
+    }
+    else if (strncasecmp(text, "Range:", 6) == 0)
+    {
+        text += 6;
+        text += strspn(text, " \t");
+        m_range = text;
+    }
+    else if (strncasecmp(text, "If-Range:", 9) == 0)
+    {
+        text += 9;
+        text += strspn(text, " \t");
+        m_if_range = text;
+    }
     else
     {
         LOG_INFO("oop!unknow header: %s", text);
@@ -327,17 +598,225 @@ http_conn::HTTP_CODE http_conn::parse_headers(char *text)
     return NO_REQUEST;
 }
 
+/**
+ * @brief 增量读取请求体
+          解码读缓冲区中已到达的请求体后将其移出,读缓冲区只需容纳请求头与一个不完整的分块头
+ *
+ * @param text 请求体在读缓冲区中的起点
+ * @return http_conn::HTTP_CODE 请求体读完返回GET_REQUEST
+ */
+http_conn::HTTP_CODE http_conn::parse_content(char *text)
+{
+    int avail = m_read_idx - m_checked_idx;
+    int used = decode_body(text, avail);
+    //流式路由把本次读到的部分立即交出,等待后续数据时不占用块
+    if (used < 0 || (m_on_body && !flush_body()))
+    {
+        return m_body_too_large ? PAYLOAD_TOO_LARGE : BAD_REQUEST;
+    }
+    if (used > 0)
+    {
+        memmove(text, text + used, avail - used);
+        m_read_idx -= used;
+        m_read_buf[m_read_idx] = '\0';
+    }
+    if (m_body_state != BODY_DONE)
+    {
+        return NO_REQUEST;
+    }
+    if (m_on_body)
+    {
+        return GET_REQUEST;
+    }
+    // POST请求中最后为输入的用户名和密码
+    if (!m_body_chunk && !body_append("", 0))
+    {
+        return INTERNAL_ERROR;
+    }
+    m_body_chunk[m_body_fill] = '\0';
+    m_body_total = m_body_fill;
+    m_string = m_body_chunk;
+    return GET_REQUEST;
+}
+
+/**
+ * @brief 按m_body_state解码一段请求体,解出的数据交给body_append
+ *
+ * @param data
+ * @param len
+ * @return int 消耗的字节数,格式错误、块池用尽或请求体超过一个块时返回-1
+ */
+int http_conn::decode_body(char *data, int len)
+{
+    //分块头与trailer行的长度上限,需小于读缓冲区
+    static const int MAX_LINE = 256;
+    int pos = 0;
+    while (pos < len && m_body_state != BODY_DONE)
+    {
+        switch (m_body_state)
+        {
+        case BODY_SIZE:
+        case BODY_TRAILER:
+        {
+            char *eol = (char *)memchr(data + pos, '\n', len - pos);
+            if (!eol)
+            {
+                return len - pos > MAX_LINE ? -1 : pos;
+            }
+            if (eol == data + pos || eol[-1] != '\r')
+            {
+                return -1;
+            }
+            char *line = data + pos;
+            int line_len = eol - 1 - line;
+            pos = eol + 1 - data;
+            if (m_body_state == BODY_TRAILER)
+            {
+                //空行结束trailer,其余trailer字段忽略
+                if (line_len == 0)
+                {
+                    m_body_state = BODY_DONE;
+                }
+                break;
+            }
+            char *end;
+            m_body_left = strtol(line, &end, 16);
+            if (end == line || m_body_left < 0 || (end != line + line_len && *end != ';' && *end != ' ' && *end != '\t'))
+            {
+                return -1;
+            }
+            m_body_state = m_body_left == 0 ? BODY_TRAILER : BODY_DATA;
+            break;
+        }
+        case BODY_DATA:
+        {
+            int n = len - pos;
+            if (n > m_body_left)
+            {
+                n = m_body_left;
+            }
+            if (!body_append(data + pos, n))
+            {
+                return -1;
+            }
+            pos += n;
+            m_body_left -= n;
+            if (m_body_left == 0)
+            {
+                m_body_state = m_chunked ? BODY_DATA_CRLF : BODY_DONE;
+            }
+            break;
+        }
+        case BODY_DATA_CRLF:
+        {
+            if (len - pos < 2)
+            {
+                return pos;
+            }
+            if (data[pos] != '\r' || data[pos + 1] != '\n')
+            {
+                return -1;
+            }
+            pos += 2;
+            m_body_state = BODY_SIZE;
+            break;
+        }
+        default:
+            return -1;
+        }
+    }
+    return pos;
+}
+
+/**
+ * @brief 把解码后的请求体追加到当前块
+          普通路由的处理函数拿到的是完整的请求体,放不进一个块时不再读取,由调用方回复413;
+          流式路由每攒满一块就交给m_on_body,请求体大小不受块大小限制
+ *
+ * @param data
+ * @param len
+ * @return true
+ * @return false 块池已用尽、请求体超过一个块或流式处理函数拒绝
+ */
+bool http_conn::body_append(const char *data, int len)
+{
+    do
+    {
+        if (!m_body_chunk)
+        {
+            m_body_chunk = chunk_pool::get_instance()->get();
+            if (!m_body_chunk)
+            {
+                LOG_WARN("chunk pool exhausted, reject request body");
+                return false;
+            }
+            m_body_fill = 0;
+        }
+        //保留一个字节给结尾的'\0'
+        int room = chunk_pool::CHUNK_SIZE - 1 - m_body_fill;
+        if (len > room && !m_on_body)
+        {
+            m_body_too_large = true;
+            return false;
+        }
+        int n = len < room ? len : room;
+        memcpy(m_body_chunk + m_body_fill, data, n);
+        m_body_fill += n;
+        data += n;
+        len -= n;
+        if (len > 0 && !flush_body())
+        {
+            return false;
+        }
+    } while (len > 0);
+    return true;
+}
+
+/**
+ * @brief 把当前块交给流式路由的处理函数,随后归还块池
+ *
+ * @return false 处理函数拒绝了请求体
+ */
+bool http_conn::flush_body()
+{
+    if (!m_body_chunk || m_body_fill == 0)
+    {
+        return true;
+    }
+    m_body_chunk[m_body_fill] = '\0';
+    m_body_total += m_body_fill;
+    //读路径上不持有数据库连接
+    request_view req = {m_method, m_url, nullptr, nullptr, m_body_total};
+    bool ok = m_on_body(req, m_body_chunk, m_body_fill);
+    release_body();
+    return ok;
+}
+
+void http_conn::release_body()
+{
+    if (m_body_chunk)
+    {
+        chunk_pool::get_instance()->put(m_body_chunk);
+        m_body_chunk = 0;
+    }
+}
+
 http_conn::HTTP_CODE http_conn::process_read()
 {
     LINE_STATUS line_status = LINE_OK;
     HTTP_CODE ret = NO_REQUEST;
     char *text = 0;
 
-    while ((m_check_state == CHECK_STATE_CONTENT && line_status == LINE_OK) || ((line_status = parse_line()) == LINE_OK))
+    //请求体不按行解析,parse_line会改写其中的\r\n
+    while ((m_check_state == CHECK_STATE_CONTENT && line_status == LINE_OK) ||
+           (m_check_state != CHECK_STATE_CONTENT && (line_status = parse_line()) == LINE_OK))
     {
         text = get_line();
         m_start_line = m_checked_idx;
-        LOG_INFO("%s", text);
+        if (m_check_state != CHECK_STATE_CONTENT)
+        {
+            LOG_INFO("%s", text);
+        }
         switch (m_check_state)
         {
         case CHECK_STATE_REQUESTLINE:
@@ -350,8 +829,8 @@ http_conn::HTTP_CODE http_conn::process_read()
         case CHECK_STATE_HEADER:
         {
             ret = parse_headers(text);
-            if (ret == BAD_REQUEST)
-                return BAD_REQUEST;
+            if (ret == BAD_REQUEST || ret == PAYLOAD_TOO_LARGE)
+                return ret;
             else if (ret == GET_REQUEST)
             {
                 return do_request();
@@ -363,6 +842,8 @@ http_conn::HTTP_CODE http_conn::process_read()
             ret = parse_content(text);
             if (ret == GET_REQUEST)
                 return do_request();
+            else if (ret != NO_REQUEST)
+                return ret;
             line_status = LINE_OPEN;
             break;
         }
@@ -373,119 +854,134 @@ http_conn::HTTP_CODE http_conn::process_read()
     return NO_REQUEST;
 }
 
-http_conn::HTTP_CODE http_conn::do_request()
+/**
+ * @brief 从"user=xxx&password=yyy"中取出用户名和密码
+ *
+ * @param body
+ * @param name
+ * @param password
+ * @param size name与password的缓冲区大小
+ * @return false 格式不对或字段过长
+ */
+static bool parse_form(const char *body, char *name, char *password, size_t size)
 {
-    strcpy(m_real_file, doc_root);
-    int len = strlen(doc_root);
-    //printf("m_url:%s\n", m_url);
-    const char *p = strrchr(m_url, '/');
-
-    //处理cgi
-    if (cgi == 1 && (*(p + 1) == '2' || *(p + 1) == '3'))
-    {
-
-        //根据标志判断是登录检测还是注册检测
-        char flag = m_url[1];
-
-        char *m_url_real = (char *)malloc(sizeof(char) * 200);
-        strcpy(m_url_real, "/");
-        strcat(m_url_real, m_url + 2);
-        strncpy(m_real_file + len, m_url_real, FILENAME_LEN - len - 1);
-        free(m_url_real);
-
-        //将用户名和密码提取出来
-        //user=123&passwd=123
-        char name[100], password[100];
-        int i;
-        for (i = 5; m_string[i] != '&'; ++i)
-            name[i - 5] = m_string[i];
-        name[i - 5] = '\0';
-
-        int j = 0;
-        for (i = i + 10; m_string[i] != '\0'; ++i, ++j)
-            password[j] = m_string[i];
-        password[j] = '\0';
-
-        if (*(p + 1) == '3')
-        {
-            //如果是注册，先检测数据库中是否有重名的
-            //没有重名的，进行增加数据
-            char *sql_insert = (char *)malloc(sizeof(char) * 200);
-            strcpy(sql_insert, "INSERT INTO tinyweb。t_user(username, passwd) VALUES(");
-            strcat(sql_insert, "'");
-            strcat(sql_insert, name);
-            strcat(sql_insert, "', '");
-            strcat(sql_insert, password);
-            strcat(sql_insert, "')");
-
-            if (users.find(name) == users.end())
-            {
-                m_lock.lock();
-                int res = mysql_query(mysql, sql_insert);
-                users.insert(pair<string, string>(name, password));
-                m_lock.unlock();
-
-                if (!res)
-                    strcpy(m_url, "/log.html");
-                else
-                    strcpy(m_url, "/registerError.html");
-            }
-            else
-                strcpy(m_url, "/registerError.html");
-        }
-        //如果是登录，直接判断
-        //若浏览器端输入的用户名和密码在表中可以查找到，返回1，否则返回0
-        else if (*(p + 1) == '2')
-        {
-            if (users.find(name) != users.end() && users[name] == password)
-                strcpy(m_url, "/welcome.html");
-            else
-                strcpy(m_url, "/logError.html");
-        }
+    if (strncmp(body, "user=", 5) != 0)
+    {
+        return false;
     }
-
-    if (*(p + 1) == '0')
+    body += 5;
+    const char *amp = strchr(body, '&');
+    if (!amp || (size_t)(amp - body) >= size)
     {
-        char *m_url_real = (char *)malloc(sizeof(char) * 200);
-        strcpy(m_url_real, "/register.html");
-        strncpy(m_real_file + len, m_url_real, strlen(m_url_real));
-
-        free(m_url_real);
+        return false;
     }
-    else if (*(p + 1) == '1')
+    memcpy(name, body, amp - body);
+    name[amp - body] = '\0';
+    const char *value = strchr(amp, '=');
+    if (!value || strlen(value + 1) >= size)
     {
-        char *m_url_real = (char *)malloc(sizeof(char) * 200);
-        strcpy(m_url_real, "/log.html");
-        strncpy(m_real_file + len, m_url_real, strlen(m_url_real));
+        return false;
+    }
+    strcpy(password, value + 1);
+    return true;
+}
 
-        free(m_url_real);
+//登录: 若浏览器端输入的用户名和密码在表中可以查找到则进入欢迎页
+static const char *login_handler(const request_view &req)
+{
+    char name[100], password[100];
+    if (!req.body || !parse_form(req.body, name, password, sizeof(name)))
+    {
+        return nullptr;
     }
-    else if (*(p + 1) == '5')
+    const char *stored = find_user(name);
+    if (stored && strcmp(stored, password) == 0)
     {
-        char *m_url_real = (char *)malloc(sizeof(char) * 200);
-        strcpy(m_url_real, "/picture.html");
-        strncpy(m_real_file + len, m_url_real, strlen(m_url_real));
+        return "/welcome.html";
+    }
+    return "/logError.html";
+}
 
-        free(m_url_real);
+//注册: 先检测数据库中是否有重名的,没有重名的再增加数据
+static const char *register_handler(const request_view &req)
+{
+    char name[100], password[100];
+    if (!req.body || !parse_form(req.body, name, password, sizeof(name)))
+    {
+        return nullptr;
     }
-    else if (*(p + 1) == '6')
+    if (find_user(name))
     {
-        char *m_url_real = (char *)malloc(sizeof(char) * 200);
-        strcpy(m_url_real, "/video.html");
-        strncpy(m_real_file + len, m_url_real, strlen(m_url_real));
-
-        free(m_url_real);
+        return "/registerError.html";
     }
-    else if (*(p + 1) == '7')
+    //表单字段转义后才能拼进SQL,转义后长度最多为原长的两倍
+    char esc_name[2 * sizeof(name) + 1], esc_password[2 * sizeof(password) + 1];
+    unsigned long name_len = mysql_real_escape_string(req.mysql, esc_name, name, strlen(name));
+    unsigned long password_len = mysql_real_escape_string(req.mysql, esc_password, password, strlen(password));
+    static const char fmt[] = "INSERT INTO tinyweb.t_user(username, passwd) VALUES('%s', '%s')";
+    string sql_insert(sizeof(fmt) + name_len + password_len, '\0');
+    int n = snprintf(&sql_insert[0], sql_insert.size(), fmt, esc_name, esc_password);
+    if (n < 0 || (size_t)n >= sql_insert.size())
     {
-        char *m_url_real = (char *)malloc(sizeof(char) * 200);
-        strcpy(m_url_real, "/fans.html");
-        strncpy(m_real_file + len, m_url_real, strlen(m_url_real));
+        return "/registerError.html";
+    }
+    m_lock.lock();
+    int res = mysql_query(req.mysql, sql_insert.c_str());
+    users.insert(pair<string, string>(name, password));
+    m_lock.unlock();
+    return res ? "/registerError.html" : "/log.html";
+}
+
+/**
+ * @brief 注册页面使用的路由,需在开始服务前调用
+ *
+ * @param root 资源根目录
+ */
+void http_conn::init_routes(const char *root)
+{
+    router *r = router::get_instance();
+    r->init(root);
+    //页面上的表单以POST跳转,两种方法都映射到同一页面
+    int get_post = router::method_bit(GET) | router::method_bit(POST);
+    r->add("/0", get_post, "/register.html");
+    r->add("/1", get_post, "/log.html");
+    r->add("/5", get_post, "/picture.html");
+    r->add("/6", get_post, "/video.html");
+    r->add("/7", get_post, "/fans.html");
+    r->add("/2CGISQL.cgi", router::method_bit(POST), nullptr, login_handler);
+    //登录只查内存中的用户表,注册需要写数据库
+    r->add("/3CGISQL.cgi", router::method_bit(POST), nullptr, register_handler, true);
+}
 
-        free(m_url_real);
+http_conn::HTTP_CODE http_conn::do_request()
+{
+    const router::route *route = router::get_instance()->match(m_method, m_url);
+    if (route && route->handler)
+    {
+        //处理普通请求的线程不持有数据库连接,交给阻塞线程池
+        if (route->blocking && !mysql)
+        {
+            return DEFERRED_REQUEST;
+        }
+        request_view req = {m_method, m_url, m_string, mysql, m_body_total};
+        const char *target = route->handler(req);
+        if (!target)
+        {
+            return BAD_REQUEST;
+        }
+        snprintf(m_real_file, FILENAME_LEN, "%s%s", doc_root, target);
+    }
+    else if (route)
+    {
+        //静态映射的完整路径注册时已拼好
+        memcpy(m_real_file, route->file.c_str(), route->file.size() + 1);
     }
     else
+    {
+        int len = strlen(doc_root);
+        strcpy(m_real_file, doc_root);
         strncpy(m_real_file + len, m_url, FILENAME_LEN - len - 1);
+    }
 
     if (stat(m_real_file, &m_file_stat) < 0)
         return NO_RESOURCE;
@@ -496,12 +992,203 @@ http_conn::HTTP_CODE http_conn::do_request()
     if (S_ISDIR(m_file_stat.st_mode))
         return BAD_REQUEST;
 
-    int fd = open(m_real_file, O_RDONLY);
-    m_file_address = (char *)mmap(0, m_file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
-    close(fd);
+    //有预压缩变体且客户端接受时直接从内存发送,不再打开和映射原文件
+    const precompress::entry *variant = precompress::lookup(m_real_file, m_file_stat);
+    if (variant)
+    {
+        m_vary = true;
+        if ((m_accept_encoding & precompress::ENC_BR) && !variant->br.empty())
+        {
+            m_content_encoding = "br";
+            m_body = variant->br.data();
+            m_body_len = variant->br.size();
+        }
+        else if ((m_accept_encoding & precompress::ENC_GZIP) && !variant->gzip.empty())
+        {
+            m_content_encoding = "gzip";
+            m_body = variant->gzip.data();
+            m_body_len = variant->gzip.size();
+        }
+    }
+
+    //校验器只依赖stat结果,缓存仍有效时无需打开文件
+    make_validators();
+    if (not_modified())
+    {
+        return NOT_MODIFIED;
+    }
+
+    HTTP_CODE ret = parse_range(m_content_encoding ? m_body_len : m_file_stat.st_size);
+    if (ret == RANGE_NOT_SATISFIABLE)
+    {
+        return ret;
+    }
+    if (m_content_encoding)
+    {
+        if (ret == PARTIAL_CONTENT)
+        {
+            m_body += m_range_start;
+        }
+        return ret;
+    }
+
+    m_file_fd = open(m_real_file, O_RDONLY | O_CLOEXEC);
+    if (ret == PARTIAL_CONTENT)
+    {
+        //部分响应不映射文件,由write()/io_uring按偏移从m_file_fd零拷贝发送
+        if (m_file_fd < 0)
+        {
+            return INTERNAL_ERROR;
+        }
+        m_file_off = m_range_start;
+        return PARTIAL_CONTENT;
+    }
+    m_file_address = (char *)mmap(0, m_file_stat.st_size, PROT_READ, MAP_PRIVATE, m_file_fd, 0);
+    m_body = m_file_address;
+    m_body_len = m_file_stat.st_size;
     return FILE_REQUEST;
 }
 
+/**
+ * @brief 由m_file_stat生成ETag与Last-Modified
+          压缩变体与原文件是不同的表示,ETag追加编码名加以区分
+ *
+ */
+void http_conn::make_validators()
+{
+    snprintf(m_etag, sizeof(m_etag), "\"%lx-%lx-%lx%s%s\"", (unsigned long)m_file_stat.st_ino,
+             (unsigned long)m_file_stat.st_size, (unsigned long)m_file_stat.st_mtime,
+             m_content_encoding ? "-" : "", m_content_encoding ? m_content_encoding : "");
+    struct tm tm;
+    gmtime_r(&m_file_stat.st_mtime, &tm);
+    strftime(m_last_modified, sizeof(m_last_modified), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+}
+
+/**
+ * @brief 判断条件GET是否命中缓存
+          If-None-Match存在时忽略If-Modified-Since,ETag按弱比较
+ *
+ * @return true 应回复304
+ */
+bool http_conn::not_modified()
+{
+    if (cgi == 1)
+    {
+        return false;
+    }
+    if (m_if_none_match)
+    {
+        size_t etag_len = strlen(m_etag);
+        const char *p = m_if_none_match;
+        while (*p)
+        {
+            p += strspn(p, " \t,");
+            if (*p == '*')
+            {
+                return true;
+            }
+            if (strncmp(p, "W/", 2) == 0)
+            {
+                p += 2;
+            }
+            size_t len = strcspn(p, " \t,");
+            if (len == etag_len && strncmp(p, m_etag, len) == 0)
+            {
+                return true;
+            }
+            p += len;
+        }
+        return false;
+    }
+    if (m_if_modified_since)
+    {
+        struct tm tm;
+        memset(&tm, 0, sizeof(tm));
+        if (!strptime(m_if_modified_since, "%a, %d %b %Y %H:%M:%S GMT", &tm))
+        {
+            return false;
+        }
+        return m_file_stat.st_mtime <= timegm(&tm);
+    }
+    return false;
+}
+
+/**
+ * @brief 解析单一字节范围,多范围与语法错误的Range按无Range处理
+          If-Range与当前校验器不一致时同样忽略Range,返回完整内容
+ *
+ * @param total 所选表示的完整长度
+ * @return http_conn::HTTP_CODE PARTIAL_CONTENT时m_range_start与m_body_len为所需的范围
+ */
+http_conn::HTTP_CODE http_conn::parse_range(off_t total)
+{
+    m_range_total = total;
+    if (!m_range || cgi == 1 || strncasecmp(m_range, "bytes=", 6) != 0 || strchr(m_range, ','))
+    {
+        return FILE_REQUEST;
+    }
+    if (m_if_range)
+    {
+        //只接受强校验器: ETag原样比较,日期须与Last-Modified一致
+        if (m_if_range[0] == '"' ? strcmp(m_if_range, m_etag) != 0 : strcmp(m_if_range, m_last_modified) != 0)
+        {
+            return FILE_REQUEST;
+        }
+    }
+
+    const char *p = m_range + 6;
+    p += strspn(p, " \t");
+    char *end;
+    off_t first, last;
+    if (*p == '-')
+    {
+        //后缀范围: bytes=-N 表示最后N个字节
+        off_t suffix = strtoll(p + 1, &end, 10);
+        if (end == p + 1 || *end != '\0')
+        {
+            return FILE_REQUEST;
+        }
+        if (suffix <= 0 || total == 0)
+        {
+            return RANGE_NOT_SATISFIABLE;
+        }
+        first = suffix >= total ? 0 : total - suffix;
+        last = total - 1;
+    }
+    else
+    {
+        first = strtoll(p, &end, 10);
+        if (end == p || *end != '-')
+        {
+            return FILE_REQUEST;
+        }
+        p = end + 1;
+        if (*p == '\0')
+        {
+            last = total - 1;
+        }
+        else
+        {
+            last = strtoll(p, &end, 10);
+            if (*end != '\0' || last < first)
+            {
+                return FILE_REQUEST;
+            }
+            if (last >= total)
+            {
+                last = total - 1;
+            }
+        }
+        if (first >= total)
+        {
+            return RANGE_NOT_SATISFIABLE;
+        }
+    }
+    m_range_start = first;
+    m_body_len = last - first + 1;
+    return PARTIAL_CONTENT;
+}
+
 void http_conn::unmap()
 {
     if (m_file_address)
@@ -509,18 +1196,63 @@ void http_conn::unmap()
         munmap(m_file_address, m_file_stat.st_size);
         m_file_address = 0;
     }
+    if (m_file_fd >= 0)
+    {
+        close(m_file_fd);
+        m_file_fd = -1;
+    }
+}
+
+/**
+ * @brief io_uring后端收到数据后追加到读缓冲区
+ *
+ * @param buf
+ * @param len
+ * @return int 实际追加的字节数,读缓冲区满时小于len,其余由事件循环暂存
+ */
+int http_conn::read_from(const char *buf, int len)
+{
+    if (m_read_idx + len > READ_BUFFER_SIZE)
+    {
+        len = READ_BUFFER_SIZE - m_read_idx;
+    }
+    memcpy(m_read_buf + m_read_idx, buf, len);
+    m_read_idx += len;
+    return len;
+}
+
+/**
+ * @brief io_uring后端发送完响应后调用,与write()发送完毕时的处理一致
+ *
+ * @return true 长连接,继续等待下一个请求
+ * @return false 需要关闭连接
+ */
+bool http_conn::send_done()
+{
+    unmap();
+    if (m_linger)
+    {
+        init();
+        return true;
+    }
+    return false;
 }
 
 bool http_conn::write(){
-    int temp = 0;
+    ssize_t temp = 0;
     if(bytes_to_send == 0){
         util.modfd(m_epollfd,m_sockfd,EPOLLIN,m_TRIGMode);
         init();
         return true;
     }
 
+    //部分响应的响应体没有映射,响应头发完后改用sendfile按偏移发送
+    bool zero_copy = m_iv_count == 2 && m_iv[1].iov_base == nullptr;
     while(1){
-        temp = writev(m_sockfd,m_iv,m_iv_count);
+        if (zero_copy && m_iv[0].iov_len == 0)
+            temp = sendfile(m_sockfd, m_file_fd, &m_file_off, bytes_to_send);
+        else
+            temp = writev(m_sockfd, m_iv, zero_copy ? 1 : m_iv_count);
         if (temp < 0)
         {
             if (errno == EAGAIN)
@@ -534,16 +1266,18 @@ bool http_conn::write(){
 
         bytes_have_send += temp;
         bytes_to_send -= temp;
-        if (bytes_have_send >= m_iv[0].iov_len)
+        //以响应头的总长判断,m_iv[0].iov_len在部分发送后已缩短
+        if (bytes_have_send >= m_write_idx)
         {
             m_iv[0].iov_len = 0;
-            m_iv[1].iov_base = m_file_address + (bytes_have_send - m_write_idx);
+            if (!zero_copy)
+                m_iv[1].iov_base = (char *)m_body + (bytes_have_send - m_write_idx);
             m_iv[1].iov_len = bytes_to_send;
         }
         else
         {
             m_iv[0].iov_base = m_write_buf + bytes_have_send;
-            m_iv[0].iov_len = m_iv[0].iov_len - bytes_have_send;
+            m_iv[0].iov_len = m_write_idx - bytes_have_send;
         }
 
         if (bytes_to_send <= 0)
@@ -586,14 +1320,14 @@ bool http_conn::add_status_line(int status, const char *title)
 {
     return add_response("%s %d %s\r\n", "HTTP/1.1", status, title);
 }
-bool http_conn::add_headers(int content_len)
+bool http_conn::add_headers(off_t content_len)
 {
-    return add_content_length(content_len) && add_linger() &&
-           add_blank_line();
+    return add_content_length(content_len) && add_linger() && add_encoding() &&
+           add_validators() && add_blank_line();
 }
-bool http_conn::add_content_length(int content_len)
+bool http_conn::add_content_length(off_t content_len)
 {
-    return add_response("Content-Length:%d\r\n", content_len);
+    return add_response("Content-Length:%lld\r\n", (long long)content_len);
 }
 bool http_conn::add_content_type()
 {
@@ -601,8 +1335,30 @@ bool http_conn::add_content_type()
 }
 bool http_conn::add_linger()
 {
+    if (m_draining)
+    {
+        m_linger = false;
+    }
     return add_response("Connection:%s\r\n", (m_linger == true) ? "keep-alive" : "close");
 }
+bool http_conn::add_encoding()
+{
+    if (m_content_encoding && !add_response("Content-Encoding:%s\r\n", m_content_encoding))
+    {
+        return false;
+    }
+    //同一URL的响应随Accept-Encoding变化,缓存需按其区分
+    return !m_vary || add_response("Vary:Accept-Encoding\r\n");
+}
+bool http_conn::add_validators()
+{
+    if (m_etag[0] == '\0')
+    {
+        return true;
+    }
+    return add_response("ETag:%s\r\n", m_etag) && add_response("Last-Modified:%s\r\n", m_last_modified) &&
+           add_response("Accept-Ranges:bytes\r\n");
+}
 bool http_conn::add_blank_line()
 {
     return add_response("%s", "\r\n");
@@ -632,6 +1388,24 @@ bool http_conn::process_write(HTTP_CODE ret)
             return false;
         break;
     }
+    case PAYLOAD_TOO_LARGE:
+    {
+        //未读的请求体还留在socket中,回复后关闭连接
+        m_linger = false;
+        add_status_line(413, error_413_title);
+        add_headers(strlen(error_413_form));
+        if (!add_content(error_413_form))
+            return false;
+        break;
+    }
+    case SERVICE_UNAVAILABLE:
+    {
+        add_status_line(503, error_503_title);
+        if (!add_response("Retry-After:1\r\n") || !add_headers(strlen(error_503_form)) ||
+            !add_content(error_503_form))
+            return false;
+        break;
+    }
     case FORBIDDEN_REQUEST:
     {
         add_status_line(403, error_403_title);
@@ -640,18 +1414,48 @@ bool http_conn::process_write(HTTP_CODE ret)
             return false;
         break;
     }
+    case NOT_MODIFIED:
+    {
+        // 304没有响应体,不带Content-Length与Content-Encoding
+        add_status_line(304, not_modified_304_title);
+        if (!add_linger() || !add_validators() || (m_vary && !add_response("Vary:Accept-Encoding\r\n")) ||
+            !add_blank_line())
+            return false;
+        break;
+    }
+    case RANGE_NOT_SATISFIABLE:
+    {
+        add_status_line(416, error_416_title);
+        if (!add_response("Content-Range:bytes */%lld\r\n", (long long)m_range_total) || !add_headers(0))
+            return false;
+        break;
+    }
+    case PARTIAL_CONTENT:
+    {
+        add_status_line(206, partial_206_title);
+        add_response("Content-Range:bytes %lld-%lld/%lld\r\n", (long long)m_range_start,
+                     (long long)(m_range_start + m_body_len - 1), (long long)m_range_total);
+        add_headers(m_body_len);
+        m_iv[0].iov_base = m_write_buf;
+        m_iv[0].iov_len = m_write_idx;
+        m_iv[1].iov_base = (char *)m_body;
+        m_iv[1].iov_len = m_body_len;
+        m_iv_count = 2;
+        bytes_to_send = m_write_idx + m_body_len;
+        return true;
+    }
     case FILE_REQUEST:
     {
         add_status_line(200, ok_200_title);
-        if (m_file_stat.st_size != 0)
+        if (m_body_len != 0)
         {
-            add_headers(m_file_stat.st_size);
+            add_headers(m_body_len);
             m_iv[0].iov_base = m_write_buf;
             m_iv[0].iov_len = m_write_idx;
-            m_iv[1].iov_base = m_file_address;
-            m_iv[1].iov_len = m_file_stat.st_size;
+            m_iv[1].iov_base = (char *)m_body;
+            m_iv[1].iov_len = m_body_len;
             m_iv_count = 2;
-            bytes_to_send = m_write_idx + m_file_stat.st_size;
+            bytes_to_send = m_write_idx + m_body_len;
             return true;
         }
         else
@@ -672,13 +1476,66 @@ bool http_conn::process_write(HTTP_CODE ret)
     return true;
 }
 
+/**
+ * @brief 把DEFERRED_REQUEST交给阻塞线程池
+ *
+ * @return false 阻塞线程池的队列已满
+ */
+bool http_conn::defer()
+{
+    m_deferred = true;
+    m_deferred_gen = m_conn_gen;
+    ++m_offloaded;
+    if (m_blocking_pool && m_blocking_pool->append_p(this))
+    {
+        return true;
+    }
+    --m_offloaded;
+    m_deferred = false;
+    return false;
+}
+
 void http_conn::process()
 {
-    HTTP_CODE read_ret = process_read();
-    if (read_ret == NO_REQUEST)
+    HTTP_CODE read_ret;
+    bool deferred = m_deferred;
+    if (deferred)
     {
-        util.modfd(m_epollfd, m_sockfd, EPOLLIN, m_TRIGMode);
-        return;
+        //阻塞线程池: 请求已解析完毕,持有数据库连接执行处理函数
+        m_deferred = false;
+        read_ret = do_request();
+        //处理期间连接已关闭且fd被新连接复用,响应不能发给新连接
+        if (m_deferred_gen != m_conn_gen)
+        {
+            LOG_WARN("connection closed while its request was deferred, drop the response");
+            --m_offloaded;
+            return;
+        }
+        if (m_deferred_hook)
+        {
+            m_deferred_ret = read_ret;
+            m_deferred_hook(this);
+            --m_offloaded;
+            return;
+        }
+    }
+    else
+    {
+        read_ret = process_read();
+        if (read_ret == NO_REQUEST)
+        {
+            util.modfd(m_epollfd, m_sockfd, EPOLLIN, m_TRIGMode);
+            return;
+        }
+        if (read_ret == DEFERRED_REQUEST)
+        {
+            //不在本线程等待数据库,阻塞线程池的队列已满时回复503
+            if (defer())
+            {
+                return;
+            }
+            read_ret = SERVICE_UNAVAILABLE;
+        }
     }
     bool write_ret = process_write(read_ret);
     if (!write_ret)
@@ -686,4 +1543,9 @@ void http_conn::process()
         close_conn();
     }
     util.modfd(m_epollfd, m_sockfd, EPOLLOUT, m_TRIGMode);
+    //交还事件循环之后才解除,此前定时器不会关闭连接
+    if (deferred)
+    {
+        --m_offloaded;
+    }
 }
\ No newline at end of file
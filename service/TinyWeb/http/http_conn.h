@@ -33,12 +33,18 @@
 #include <error.h>      // for error 标准C库头文件头文件定义了一系列表示不同错误代码的宏
 #include <sys/wait.h>   //POSIX 进程控制
 #include <sys/uio.h>    // POSIX 矢量I/O操作
+#include <time.h>       // for strftime/strptime 生成与解析HTTP日期
 #include <map>          //stl map容器
+#include <atomic>       //stl 原子操作
 
 #include "../lock/locker.h"                  //自定义 线程同步机制包装类
 #include "../CGImysql/sql_connection_pool.h" //自定义 数据库连接池
+#include "../CGImysql/user_snapshot.h"       //自定义 用户表快照
 #include "../timer/lst_timer.h"              //自定义 定时器处理非活动连接
 #include "../log/log.h"                      //自定义 日志模块
+#include "../threadpool/threadpool.h"        //自定义 线程池
+
+struct request_view;
 
 class http_conn
 {
@@ -74,6 +80,12 @@ public:
         NO_RESOURCE,
         FORBIDDEN_REQUEST,
         FILE_REQUEST,
+        NOT_MODIFIED,
+        PARTIAL_CONTENT,
+        RANGE_NOT_SATISFIABLE,
+        PAYLOAD_TOO_LARGE, //请求体超过一个块
+        DEFERRED_REQUEST, //处理函数需要数据库连接,由阻塞线程池完成
+        SERVICE_UNAVAILABLE,
         INTERNAL_ERROR,
         CLOSED_CONNECTION
     };
@@ -85,10 +97,26 @@ public:
         LINE_OPEN
     };
 
+    //请求体解码状态, Content-Length请求体只用到BODY_DATA与BODY_DONE
+    enum BODY_STATE
+    {
+        BODY_SIZE = 0,
+        BODY_DATA,
+        BODY_DATA_CRLF,
+        BODY_TRAILER,
+        BODY_DONE
+    };
+
 public:
-    http_conn() {}
+    http_conn() : m_offloaded(0), m_conn_gen(0), m_deferred_gen(0), m_file_address(0), m_file_fd(-1), m_body(0), m_body_chunk(0), m_on_body(0) {}
     ~http_conn() {}
 
+    //微基准(bench/micro_bench.cpp)直接调用解析函数
+    friend class http_parse_bench;
+    //协程引擎(coro/coro_loop.cpp)在事件循环线程中逐步驱动连接
+    friend class coro_loop;
+    friend class coro_session;
+
 public:
     void init(int sockfd, const sockaddr_in &addr, char *, int, int, string user, string passwd, string sqlname);
     void close_conn(bool real_close = true);
@@ -100,7 +128,22 @@ public:
         return &m_address;
     }
 
-    void initmysql_result(connection_pool *connPool);
+    // io_uring后端: 事件循环读到的数据交给连接,以及取出待发送的响应
+    int read_from(const char *buf, int len);
+    bool send_done();
+    struct iovec *get_iv() { return m_iv; }
+    int get_iv_count() const { return m_iv_count; }
+    int get_file_fd() const { return m_file_fd; }
+    off_t get_file_off() const { return m_file_off; }
+
+    void initmysql_result(connection_pool *connPool, int close_log, const char *snapshot = nullptr);
+    static bool save_users(connection_pool *connPool, const char *snapshot);
+    static bool save_users(const char *snapshot, const map<string, string> &delta, const user_table_mark &mark, bool reload);
+    static void init_routes(const char *root);
+    //把已解析完的DEFERRED_REQUEST交给阻塞线程池,队列已满时返回false
+    bool defer();
+    //处理函数在阻塞线程池中尚未完成,期间定时器不关闭连接
+    bool offloaded() const { return m_offloaded > 0; }
     int timer_flag;
     int improv;
 
@@ -111,24 +154,51 @@ private:
     HTTP_CODE parse_request_line(char *text);
     HTTP_CODE parse_headers(char *text);
     HTTP_CODE parse_content(char *text);
+    int decode_body(char *data, int len);
+    bool body_append(const char *data, int len);
+    bool flush_body();
+    void release_body();
     HTTP_CODE do_request();
     char *get_line() { return m_read_buf + m_start_line; }
     LINE_STATUS parse_line();
     void unmap();
+    void make_validators();
+    bool not_modified();
+    HTTP_CODE parse_range(off_t total);
     bool add_response(const char *format, ...);
     bool add_content(const char *content);
     bool add_status_line(int status, const char *status_line);
-    bool add_headers(int content_length);
+    bool add_headers(off_t content_length);
     bool add_content_type();
-    bool add_content_length(int content_length);
+    bool add_content_length(off_t content_length);
     bool add_linger();
+    bool add_encoding();
+    bool add_validators();
     bool add_blank_line();
 public:
     static int m_epollfd;
     static int m_user_count;
+    static int m_ip_limit; //单个客户端IP的最大并发连接数,0为不限制
+    static bool m_draining; //平滑重启排空期间,响应后关闭连接
+    //执行DEFERRED_REQUEST处理函数的阻塞线程池,与处理普通请求的线程池分开
+    static threadpool<http_conn> *m_blocking_pool;
+    //协程引擎: 阻塞线程池完成处理函数后调用,为空时由工作线程继续生成响应
+    static void (*m_deferred_hook)(http_conn *conn);
+
+    /**
+     * @brief 按客户端IP计数,超过m_ip_limit时返回false,与m_user_count一样在关闭连接时归还
+     *
+     */
+    static bool acquire_ip(in_addr_t ip);
+    static void release_ip(in_addr_t ip);
     MYSQL *mysql;
     int m_state;  //读为0,写为1
 private:
+    bool m_deferred;           //请求已解析完,阻塞线程池只需执行处理函数
+    std::atomic<int> m_offloaded; //交给阻塞线程池且尚未完成的请求数,完成后由阻塞线程池减一
+    std::atomic<unsigned> m_conn_gen; //每接受一个新连接加一,区分复用同一fd的先后连接
+    unsigned m_deferred_gen;      //交给阻塞线程池时的m_conn_gen
+    HTTP_CODE m_deferred_ret;
     int m_sockfd;
     sockaddr_in m_address;
     char m_read_buf[READ_BUFFER_SIZE];
@@ -143,16 +213,39 @@ private:
     char *m_url;
     char *m_version;
     char *m_host;
-    int m_content_length;
+    long m_content_length;
     bool m_linger;
     char *m_file_address;
+    int m_file_fd; //响应文件的描述符,供sendfile/splice使用,unmap时关闭
     struct stat m_file_stat;
+    int m_accept_encoding;          //请求Accept-Encoding中可接受的precompress::ENCODING
+    const char *m_content_encoding; //响应体使用的编码,未压缩为nullptr
+    bool m_vary;                    //资源存在压缩变体时响应需带Vary
+    const char *m_body;             //响应体,指向mmap的文件或内存中的压缩变体
+    off_t m_body_len;
+    char *m_if_none_match;     //条件请求头,指向读缓冲区
+    char *m_if_modified_since;
+    char m_etag[64];           //由inode、大小、mtime生成,为空时不发送校验器
+    char m_last_modified[32];
+    char *m_range;             // Range与If-Range请求头
+    char *m_if_range;
+    off_t m_range_start;       //单一字节范围的起点,响应206时有效
+    off_t m_range_total;       //所选表示的完整长度
+    off_t m_file_off;          //响应体在m_file_fd中的起始偏移,m_body为空时按偏移零拷贝发送
     struct iovec m_iv[2];
     int m_iv_count;
     int cgi;        //是否启用post
     char *m_string; //存储请求头数据
-    int bytes_to_send;
-    int bytes_have_send;
+    bool m_chunked;           // Transfer-Encoding: chunked
+    BODY_STATE m_body_state;
+    long m_body_left;         //当前分块或Content-Length请求体中尚未读到的字节数
+    char *m_body_chunk;       //从chunk_pool取得的块,存放解码后的请求体
+    int m_body_fill;
+    bool m_body_too_large;    //请求体超过一个块,停止读取并回复413
+    bool (*m_on_body)(const request_view &req, const char *data, int len); //路由的流式请求体处理函数,为空时请求体须装进一个块
+    long long m_body_total;   //已解码的请求体字节数
+    off_t bytes_to_send;   //响应头与响应体合计,大文件可超过2GB
+    off_t bytes_have_send;
     char *doc_root;
 
     map<string, string> m_users;
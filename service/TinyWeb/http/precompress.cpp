@@ -0,0 +1,223 @@
+#include <dirent.h>   // POSIX 目录操作
+#include <unistd.h>   // for unistd POSIX 符号常量
+#include <fcntl.h>    // for fcntl POSIX 文件控制
+#include <string.h>   // for string 标准C库头文件,定义C语言字符串处理函数
+#include <strings.h>  // for strncasecmp
+#include <stdlib.h>   // for atof
+#include <zlib.h>     // gzip压缩
+#ifdef TINYWEB_BROTLI
+#include <brotli/encode.h> // brotli压缩
+#endif
+#include "precompress.h"
+
+std::map<std::string, precompress::entry> precompress::m_table;
+
+//小文件压缩后省下的字节不抵响应头,大文件不放进内存
+static const off_t MIN_SIZE = 256;
+static const off_t MAX_SIZE = 4 * 1024 * 1024;
+
+static bool read_file(const std::string &path, off_t size, std::string &out)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    out.resize(size);
+    off_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = read(fd, &out[done], size - done);
+        if (n <= 0)
+        {
+            break;
+        }
+        done += n;
+    }
+    close(fd);
+    return done == size;
+}
+
+static bool gzip_compress(const std::string &in, int level, std::string &out)
+{
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    // windowBits 15 + 16 输出gzip格式
+    if (deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return false;
+    }
+    out.resize(deflateBound(&zs, in.size()) + 32);
+    zs.next_in = (Bytef *)in.data();
+    zs.avail_in = in.size();
+    zs.next_out = (Bytef *)&out[0];
+    zs.avail_out = out.size();
+    int ret = deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return ret == Z_STREAM_END;
+}
+
+#ifdef TINYWEB_BROTLI
+static bool br_compress(const std::string &in, std::string &out)
+{
+    size_t len = BrotliEncoderMaxCompressedSize(in.size());
+    if (len == 0)
+    {
+        return false;
+    }
+    out.resize(len);
+    if (!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT, in.size(),
+                               (const uint8_t *)in.data(), &len, (uint8_t *)&out[0]))
+    {
+        return false;
+    }
+    out.resize(len);
+    return true;
+}
+#endif
+
+bool precompress::compressible(const char *path)
+{
+    static const char *exts[] = {".html", ".htm", ".css", ".js", ".json", ".txt", ".svg", ".xml", ".md", ".ico"};
+    const char *dot = strrchr(path, '.');
+    if (!dot)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(exts) / sizeof(exts[0]); ++i)
+    {
+        if (strcasecmp(dot, exts[i]) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void precompress::build_file(const std::string &path, const struct stat &st, int level)
+{
+    std::string raw;
+    if (!read_file(path, st.st_size, raw))
+    {
+        return;
+    }
+    entry e;
+    e.mtime = st.st_mtime;
+    e.size = st.st_size;
+    //压缩后没有变小的变体不保留,仍会记录条目以便响应带上Vary
+    if (gzip_compress(raw, level, e.gzip) && e.gzip.size() >= raw.size())
+    {
+        e.gzip.clear();
+    }
+#ifdef TINYWEB_BROTLI
+    if (br_compress(raw, e.br) && e.br.size() >= raw.size())
+    {
+        e.br.clear();
+    }
+#endif
+    m_table[path] = e;
+}
+
+int precompress::build(const char *root, int level)
+{
+    if (level <= 0)
+    {
+        return 0;
+    }
+    if (level > 9)
+    {
+        level = 9;
+    }
+    int count = 0;
+    std::string dir = root;
+    DIR *d = opendir(root);
+    if (!d)
+    {
+        return 0;
+    }
+    struct dirent *de;
+    while ((de = readdir(d)) != nullptr)
+    {
+        if (de->d_name[0] == '.')
+        {
+            continue;
+        }
+        std::string path = dir + "/" + de->d_name;
+        struct stat st;
+        if (stat(path.c_str(), &st) < 0)
+        {
+            continue;
+        }
+        if (S_ISDIR(st.st_mode))
+        {
+            count += build(path.c_str(), level);
+            continue;
+        }
+        if (!S_ISREG(st.st_mode) || st.st_size < MIN_SIZE || st.st_size > MAX_SIZE || !compressible(de->d_name))
+        {
+            continue;
+        }
+        build_file(path, st, level);
+        ++count;
+    }
+    closedir(d);
+    return count;
+}
+
+const precompress::entry *precompress::lookup(const char *real_file, const struct stat &st)
+{
+    if (m_table.empty())
+    {
+        return nullptr;
+    }
+    std::map<std::string, entry>::const_iterator it = m_table.find(real_file);
+    if (it == m_table.end())
+    {
+        return nullptr;
+    }
+    if (it->second.mtime != st.st_mtime || it->second.size != st.st_size)
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+int precompress::parse_accept(const char *value)
+{
+    int accept = 0;
+    const char *p = value;
+    while (*p)
+    {
+        p += strspn(p, " \t,");
+        size_t len = strcspn(p, " \t,;");
+        if (len == 0)
+        {
+            break;
+        }
+        int enc = 0;
+        if (len == 4 && strncasecmp(p, "gzip", 4) == 0)
+        {
+            enc = ENC_GZIP;
+        }
+        else if (len == 2 && strncasecmp(p, "br", 2) == 0)
+        {
+            enc = ENC_BR;
+        }
+        else if (len == 1 && p[0] == '*')
+        {
+            enc = ENC_GZIP | ENC_BR;
+        }
+        p += len;
+        //只关心q=0,表示明确拒绝该编码
+        size_t param = strcspn(p, ",");
+        const char *q = strstr(p, "q=");
+        if (q && q < p + param && atof(q + 2) <= 0)
+        {
+            enc = 0;
+        }
+        accept |= enc;
+        p += param;
+    }
+    return accept;
+}
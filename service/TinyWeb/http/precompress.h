@@ -0,0 +1,72 @@
+/**
+ * @file precompress.h
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief 静态文件的预压缩变体
+            ===============
+            启动时扫描资源目录,为可压缩的文本文件在内存中生成gzip(以及编译时开启BROTLI=1时的br)变体,请求线程只做查找不做压缩.
+            > * 只处理html/css/js等文本类型,图片视频本身已压缩
+            > * 变体记录原文件的mtime与大小,文件在启动后被修改则回退为原文件
+            > * 表在开始服务前建好,之后只读,查找无需加锁
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __PRECOMPRESS_H__
+#define __PRECOMPRESS_H__
+#include <sys/stat.h> //POSIX 文件状态
+#include <string>     // stl string
+#include <map>        // stl map容器
+
+class precompress
+{
+public:
+    enum ENCODING
+    {
+        ENC_GZIP = 1,
+        ENC_BR = 2
+    };
+
+    struct entry
+    {
+        time_t mtime;
+        off_t size;
+        std::string gzip;
+        std::string br;
+    };
+
+    /**
+     * @brief 扫描root下的文件并生成压缩变体
+     *
+     * @param root 资源目录
+     * @param level gzip压缩级别1~9
+     * @return int 生成了变体的文件数
+     */
+    static int build(const char *root, int level);
+
+    /**
+     * @brief 查找real_file的压缩变体
+     *
+     * @param real_file
+     * @param st 请求时对原文件的stat,与建表时不一致则视为没有变体
+     * @return const entry* 不可压缩或已失效时返回nullptr
+     */
+    static const entry *lookup(const char *real_file, const struct stat &st);
+
+    /**
+     * @brief 解析Accept-Encoding的值
+     *
+     * @param value
+     * @return int ENCODING的按位或, q=0的编码不计入
+     */
+    static int parse_accept(const char *value);
+
+private:
+    static bool compressible(const char *path);
+    static void build_file(const std::string &path, const struct stat &st, int level);
+
+    static std::map<std::string, entry> m_table;
+};
+
+#endif /* __PRECOMPRESS_H__ */
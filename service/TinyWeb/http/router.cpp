@@ -0,0 +1,101 @@
+#include "router.h"
+
+router::router() : m_mask(0)
+{
+}
+
+router::~router()
+{
+}
+
+void router::init(const char *root)
+{
+    m_root = root;
+}
+
+// FNV-1a
+uint32_t router::hash(const char *s, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i)
+    {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool router::add(const char *path, int methods, const char *target, route_handler handler, bool blocking,
+                 body_handler on_body)
+{
+    route r;
+    r.path = path;
+    r.methods = methods;
+    r.handler = handler;
+    r.blocking = handler && blocking;
+    r.on_body = handler ? on_body : nullptr;
+    if (!handler)
+    {
+        r.file = m_root + target;
+        if (r.file.size() >= (size_t)http_conn::FILENAME_LEN)
+        {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < m_routes.size(); ++i)
+    {
+        if (m_routes[i].path == r.path)
+        {
+            m_routes[i] = r;
+            return true;
+        }
+    }
+    m_routes.push_back(r);
+    rehash();
+    return true;
+}
+
+/**
+ * @brief 重建哈希表,槽数取不小于路由数两倍的2的幂,线性探测
+ *
+ */
+void router::rehash()
+{
+    size_t size = 8;
+    while (size < m_routes.size() * 2)
+    {
+        size <<= 1;
+    }
+    m_slots.assign(size, -1);
+    m_mask = size - 1;
+    for (size_t i = 0; i < m_routes.size(); ++i)
+    {
+        uint32_t slot = hash(m_routes[i].path.data(), m_routes[i].path.size()) & m_mask;
+        while (m_slots[slot] != -1)
+        {
+            slot = (slot + 1) & m_mask;
+        }
+        m_slots[slot] = i;
+    }
+}
+
+const router::route *router::match(http_conn::METHOD method, const char *url) const
+{
+    if (m_slots.empty())
+    {
+        return nullptr;
+    }
+    size_t len = strlen(url);
+    uint32_t slot = hash(url, len) & m_mask;
+    while (m_slots[slot] != -1)
+    {
+        const route &r = m_routes[m_slots[slot]];
+        if (r.path.size() == len && memcmp(r.path.data(), url, len) == 0)
+        {
+            return (r.methods & method_bit(method)) ? &r : nullptr;
+        }
+        slot = (slot + 1) & m_mask;
+    }
+    return nullptr;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file router.h
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief 请求路由表
+            ===============
+            按完整路径与请求方法查找路由,取代do_request中按url首字符判断的分支.
+            > * 路由在开始服务前注册,之后只读,查找无需加锁
+            > * 开放寻址哈希表,查找只对url做一次哈希,与路由数量无关,不分配内存
+            > * 静态映射(如/0 -> register.html)注册时即拼好资源文件的完整路径
+            > * 处理函数只看到request_view,返回要发送的资源路径
+            > * 注册了body_handler的路由按块流式接收请求体,上传大小不受缓冲块大小限制
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __ROUTER_H__
+#define __ROUTER_H__
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "http_conn.h"
+
+//处理函数可见的请求内容,均指向连接自身的缓冲区
+struct request_view
+{
+    http_conn::METHOD method;
+    const char *url;
+    const char *body; //请求体,流式路由为nullptr
+    MYSQL *mysql;
+    long long body_len; //已解码的请求体字节数,含本次交给body_handler的一段
+};
+
+/**
+ * @brief 路由处理函数
+ *
+ * @return const char* 要返回的资源路径(相对根目录,以/开头),nullptr表示请求有误
+ */
+typedef const char *(*route_handler)(const request_view &req);
+
+/**
+ * @brief 流式请求体处理函数
+          每攒满一个缓冲块或一次读取结束时调用一次,在读路径上执行,不持有数据库连接,不应阻塞;
+          请求体读完后再照常调用route_handler
+ *
+ * @param data 解码后的一段请求体,以'\0'结尾,返回后所在的块即归还块池
+ * @param len
+ * @return false 拒绝请求,按BAD_REQUEST处理
+ */
+typedef bool (*body_handler)(const request_view &req, const char *data, int len);
+
+class router
+{
+public:
+    struct route
+    {
+        std::string path;
+        int methods;          // 1 << http_conn::METHOD 的按位或
+        std::string file;     //静态映射的资源完整路径
+        route_handler handler; //不为空时由处理函数决定资源
+        bool blocking;         //处理函数会访问数据库,需在持有数据库连接的线程中执行
+        body_handler on_body;  //不为空时请求体按块流式交给它
+    };
+
+    static router *get_instance()
+    {
+        static router instance;
+        return &instance;
+    }
+
+    static int method_bit(http_conn::METHOD method) { return 1 << method; }
+
+    //设置资源根目录,需在add之前调用
+    void init(const char *root);
+
+    /**
+     * @brief 注册路由,同一路径重复注册时覆盖
+     *
+     * @param path 请求路径
+     * @param methods 允许的方法
+     * @param target 静态映射的资源路径,handler不为空时忽略
+     * @param handler
+     * @param blocking 处理函数是否访问数据库
+     * @param on_body 流式请求体处理函数,需同时提供handler
+     * @return false 资源路径超过http_conn::FILENAME_LEN
+     */
+    bool add(const char *path, int methods, const char *target, route_handler handler = nullptr,
+             bool blocking = false, body_handler on_body = nullptr);
+
+    //未命中或方法不匹配时返回nullptr,按url直接映射根目录下的文件
+    const route *match(http_conn::METHOD method, const char *url) const;
+
+private:
+    router();
+    ~router();
+    static uint32_t hash(const char *s, size_t len);
+    void rehash();
+
+private:
+    std::string m_root;
+    std::vector<route> m_routes;
+    std::vector<int> m_slots; //存m_routes下标,-1为空槽
+    uint32_t m_mask;
+};
+
+#endif /* __ROUTER_H__ */
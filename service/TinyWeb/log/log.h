@@ -39,6 +39,7 @@ public:
     static void *flush_log_thread(void *args)
     {
         Log::get_instance()->async_write_log();
+        return nullptr;
     }
 
     bool init(const char *file_name, int close_log, int log_buf_size = 8192, int split_lines = 5000000, int max_queue_size = 0);
@@ -76,6 +77,7 @@ private:
             fputs(signal_log.c_str(), m_fp);
             m_mutex.unlock();
         }
+        return nullptr;
     }
 
     char dir_name[128]; //路径名
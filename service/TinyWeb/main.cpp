@@ -16,12 +16,22 @@ int main(int argc, char *argv[])
     //初始化
     server.init(config.PORT, user, passwd, databasename, config.LOGWrite, 
                 config.OPT_LINGER, config.TRIGMode,  config.sql_num,  config.thread_num, 
-                config.close_log, config.actor_model);
+                config.close_log, config.actor_model, config.backlog, config.accept_batch,
+                config.defer_accept, config.io_backend, config.queue_size, config.high_water,
+                config.low_water, config.ip_limit, config.compress_level,
+                config.body_chunks, config.drain_timeout, config.snapshot,
+                config.blocking_threads, config.blocking_queue);
     
 
     //日志
     server.log_write();
 
+    //路由
+    server.route_table();
+
+    //静态文件预压缩
+    server.precompress_files();
+
     //数据库
     server.sql_pool();
 
@@ -37,5 +47,8 @@ int main(int argc, char *argv[])
     //运行
     server.eventLoop();
 
+    //保存用户表快照
+    server.save_users();
+
     return 0;
 }
\ No newline at end of file
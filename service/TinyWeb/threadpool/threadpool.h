@@ -20,6 +20,7 @@
 #include <cstdio>
 #include <exception>
 #include <pthread.h>
+#include <atomic>
 #include "../lock/locker.h"
 #include "../CGImysql/sql_connection_pool.h"
 
@@ -27,16 +28,26 @@ template <typename T>
 class threadpool
 {
 public:
-    /*thread_number是线程池中线程的数量，max_requests是请求队列中最多允许的、等待处理的请求的数量*/
+    /*thread_number是线程池中线程的数量，max_requests是请求队列中最多允许的、等待处理的请求的数量;
+      connPool为空时工作线程不取数据库连接*/
     threadpool(int actor_model, connection_pool *connPool, int thread_number = 8, int max_request = 10000);
     ~threadpool();
     bool append(T *request, int state);
     bool append_p(T *request);
+    //当前排队等待处理的请求数
+    int depth();
+    //正在执行的请求数
+    int busy() const { return m_busy; }
+    //累计完成的请求数
+    long done() const { return m_done; }
+    //队列已满被拒绝的请求数
+    long rejected() const { return m_rejected; }
 
 private:
     /*工作线程运行的函数，它不断从工作队列中取出任务并执行之*/
     static void *worker(void *arg);
     void run();
+    void process(T *request);
 
 private:
     int m_thread_number;           //线程池中的线程数
@@ -47,10 +58,13 @@ private:
     sem m_queuestat;               //是否需要任务需要处理
     connection_pool *m_connPool; //数据库
     int m_actor_model;             //模型切换
+    std::atomic<int> m_busy;
+    std::atomic<long> m_done;
+    std::atomic<long> m_rejected;
 };
 
 template <typename T>
-threadpool<T>::threadpool(int actor_model, connection_pool *connPool, int thread_number, int max_requests) : m_actor_model(actor_model), m_thread_number(thread_number), m_max_requests(max_requests), m_threads(NULL), m_connPool(connPool)
+threadpool<T>::threadpool(int actor_model, connection_pool *connPool, int thread_number, int max_requests) : m_actor_model(actor_model), m_thread_number(thread_number), m_max_requests(max_requests), m_threads(NULL), m_connPool(connPool), m_busy(0), m_done(0), m_rejected(0)
 {
     if (thread_number <= 0 || max_requests <= 0)
     {
@@ -63,7 +77,7 @@ threadpool<T>::threadpool(int actor_model, connection_pool *connPool, int thread
     }
     for (int i = 0; i < thread_number; ++i)
     {
-        if (pthread_create(m_threads + i, null, worker, this) != 0)
+        if (pthread_create(m_threads + i, NULL, worker, this) != 0)
         {
             delete[] m_threads;
             throw std::exception();
@@ -93,6 +107,7 @@ bool threadpool<T>::append(T *request, int state)
     if (m_workqueue.size() >= m_max_requests)
     {
         m_queuelocker.unlock();
+        ++m_rejected;
         return false;
     }
     request->m_state = state;
@@ -109,6 +124,7 @@ bool threadpool<T>::append_p(T *request)
     if (m_workqueue.size() >= m_max_requests)
     {
         m_queuelocker.unlock();
+        ++m_rejected;
         return false;
     }
     m_workqueue.push_back(request);
@@ -117,6 +133,15 @@ bool threadpool<T>::append_p(T *request)
     return true;
 }
 
+template <typename T>
+int threadpool<T>::depth()
+{
+    m_queuelocker.lock();
+    int n = m_workqueue.size();
+    m_queuelocker.unlock();
+    return n;
+}
+
 template <typename T>
 void *threadpool<T>::worker(void *arg)
 {
@@ -146,6 +171,7 @@ void threadpool<T>::run()
             continue;
         }
 
+        ++m_busy;
         if (1 == m_actor_model)
         {
             if (0 == request->m_state)
@@ -153,8 +179,7 @@ void threadpool<T>::run()
                 if (request->read_once())
                 {
                     request->improv = 1;
-                    connectionRAII mysqlcon(&request->mysql, m_connPool);
-                    request->process();
+                    process(request);
                 }
                 else
                 {
@@ -177,9 +202,24 @@ void threadpool<T>::run()
         }
         else
         {
-            connectionRAII mysqlcon(&request->mysql, m_connPool);
-            request->process();
+            process(request);
         }
+        --m_busy;
+        ++m_done;
+    }
+}
+
+template <typename T>
+void threadpool<T>::process(T *request)
+{
+    if (m_connPool)
+    {
+        connectionRAII mysqlcon(&request->mysql, m_connPool);
+        request->process();
+    }
+    else
+    {
+        request->process();
     }
 }
 #endif
\ No newline at end of file
@@ -5,6 +5,7 @@ sort_timer_lst::sort_timer_lst()
 {
     head = nullptr;
     tail = nullptr;
+    m_idle = 0;
 }
 
 sort_timer_lst::~sort_timer_lst()
@@ -105,6 +106,7 @@ void sort_timer_lst::tick()
         return;
     }
     time_t cur = time(NULL);
+    util_timer *requeue = nullptr;
     util_timer *tmp = head;
     while (tmp)
     {
@@ -112,15 +114,71 @@ void sort_timer_lst::tick()
         {
             break;
         }
-        tmp->cb_func(tmp->user_data);
         head = tmp->next;
         if (head)
         {
             head->prev = nullptr;
         }
-        delete tmp;
+        else
+        {
+            tail = nullptr;
+        }
+        bool pinned = tmp->user_data->conn && tmp->user_data->conn->offloaded();
+        if (pinned)
+        {
+            //处理函数仍在阻塞线程池中执行,视为活动
+            tmp->last_active = cur;
+        }
+        if (pinned || (m_idle > 0 && cur < tmp->last_active + m_idle))
+        {
+            //期间有过活动,先摘下,处理完到期的定时器后再按新的到期时间插回
+            tmp->expire = tmp->last_active + m_idle;
+            tmp->prev = nullptr;
+            tmp->next = requeue;
+            requeue = tmp;
+        }
+        else
+        {
+            tmp->cb_func(tmp->user_data);
+            tmp->user_data->timer = nullptr;
+            delete tmp;
+        }
         tmp = head;
     }
+    while (requeue)
+    {
+        tmp = requeue;
+        requeue = requeue->next;
+        add_timer_back(tmp);
+    }
+}
+
+void sort_timer_lst::add_timer_back(util_timer *timer)
+{
+    util_timer *prev = tail;
+    while (prev && timer->expire < prev->expire)
+    {
+        prev = prev->prev;
+    }
+    timer->prev = prev;
+    if (prev)
+    {
+        timer->next = prev->next;
+        prev->next = timer;
+    }
+    else
+    {
+        timer->next = head;
+        head = timer;
+    }
+    if (timer->next)
+    {
+        timer->next->prev = timer;
+    }
+    else
+    {
+        tail = timer;
+    }
 }
 
 void sort_timer_lst::add_timer(util_timer *timer, util_timer *lst_head)
@@ -150,9 +208,18 @@ void sort_timer_lst::add_timer(util_timer *timer, util_timer *lst_head)
     }
 }
 
+Utils::Utils()
+{
+}
+
+Utils::~Utils()
+{
+}
+
 void Utils::init(int timeslot)
 {
     m_TIMESLOT = timeslot;
+    u_now = time(NULL);
 }
 
 /**
@@ -176,9 +243,15 @@ int Utils::setnonblocking(int fd)
  * @param fd
  * @param one_shot
  * @param TRIGMode
+ * @param nonblock
  */
-void Utils::addfd(int epollfd, int fd, int one_shot, int TRIGMode)
+void Utils::addfd(int epollfd, int fd, bool one_shot, int TRIGMode, bool nonblock)
 {
+    if (u_fd_hook)
+    {
+        u_fd_hook(EPOLL_CTL_ADD, fd, EPOLLIN);
+        return;
+    }
     epoll_event event;
     event.data.fd = fd;
     if (1 == TRIGMode)
@@ -195,7 +268,10 @@ void Utils::addfd(int epollfd, int fd, int one_shot, int TRIGMode)
         event.events |= EPOLLONESHOT;
     }
     epoll_ctl(epollfd, EPOLL_CTL_ADD, fd, &event);
-    setnonblocking(fd);
+    if (nonblock)
+    {
+        setnonblocking(fd);
+    }
 }
 /**
  * @brief 信号处理函数
@@ -255,6 +331,11 @@ void Utils::show_error(int connfd, const char *info)
  */
 void Utils::removefd(int epollfd, int fd)
 {
+    if (u_fd_hook)
+    {
+        u_fd_hook(EPOLL_CTL_DEL, fd, 0);
+        return;
+    }
     epoll_ctl(epollfd, EPOLL_CTL_DEL, fd, 0);
     close(fd);
 }
@@ -269,6 +350,11 @@ void Utils::removefd(int epollfd, int fd)
  */
 void Utils::modfd(int epollfd, int fd, int ev, int TRIGMode)
 {
+    if (u_fd_hook)
+    {
+        u_fd_hook(EPOLL_CTL_MOD, fd, ev);
+        return;
+    }
     epoll_event event;
     event.data.fd = fd;
 
@@ -282,11 +368,26 @@ void Utils::modfd(int epollfd, int fd, int ev, int TRIGMode)
 
 int *Utils::u_pipefd = 0;
 int Utils::u_epollfd = 0;
+time_t Utils::u_now = 0;
+void (*Utils::u_fd_hook)(int, int, int) = nullptr;
+void (*Utils::u_drop_hook)(int) = nullptr;
 
 class Utils;
 void cb_func(client_data *user_data){
-    epoll_ctl(Utils::u_epollfd, EPOLL_CTL_DEL,user_data->sockfd,0);
     assert(user_data);
-    close(user_data->sockfd);
+    if (Utils::u_drop_hook)
+    {
+        Utils::u_drop_hook(user_data->sockfd);
+    }
+    if (Utils::u_fd_hook)
+    {
+        Utils::u_fd_hook(EPOLL_CTL_DEL, user_data->sockfd, 0);
+    }
+    else
+    {
+        epoll_ctl(Utils::u_epollfd, EPOLL_CTL_DEL, user_data->sockfd, 0);
+        close(user_data->sockfd);
+    }
     http_conn::m_user_count--;
+    http_conn::release_ip(user_data->address.sin_addr.s_addr);
 }
\ No newline at end of file
@@ -36,23 +36,26 @@
 #include <sys/uio.h>    // POSIX 矢量I/O操作
 
 class util_timer;
+class http_conn;
 
 struct client_data
 {
     sockaddr_in address;
     int sockfd;
-    util_timer *timer;
+    util_timer *timer; //定时器到期或连接关闭后置空
+    http_conn *conn;
 };
 
 class util_timer
 {
 public:
-    util_timer() : prev(nullptr), next(nullptr)
+    util_timer() : last_active(0), prev(nullptr), next(nullptr)
     {
     }
 
 public:
     time_t expire;
+    time_t last_active; //最近一次读写的时间,只记录不调整链表,到期时再决定是否续期
     void (*cb_func)(client_data *);
     client_data *user_data;
     util_timer *prev;
@@ -68,12 +71,21 @@ public:
     void add_timer(util_timer *timer);
     void adjust_timer(util_timer *timer);
     void del_timer(util_timer *timer);
+    /**
+     * @brief 处理到期的定时器;到期前仍有活动的连接按last_active + idle重新入队而不关闭,
+              处理函数仍在阻塞线程池中执行的连接同样续期,关闭后fd会被复用
+     *
+     */
     void tick();
+    void set_idle(time_t idle) { m_idle = idle; }
 
 private:
     void add_timer(util_timer *timer, util_timer *lst_head);
+    //从表尾向前找插入位置,续期的定时器到期时间接近最晚,通常O(1)
+    void add_timer_back(util_timer *timer);
     util_timer *head;
     util_timer *tail;
+    time_t m_idle; //非活动超时时长,0为不续期
 };
 
 class Utils
@@ -97,8 +109,9 @@ public:
      * @param fd
      * @param one_shot
      * @param TRIGMode
+     * @param nonblock 是否需要设置非阻塞,accept4得到的connfd已是非阻塞
      */
-    void addfd(int epollfd, int fd, bool one_shot, int TRIGMode);
+    void addfd(int epollfd, int fd, bool one_shot, int TRIGMode, bool nonblock = true);
     /**
      * @brief 信号处理函数
      *
@@ -140,7 +153,15 @@ public:
     static int *u_pipefd;
     sort_timer_lst m_timer_lst;
     static int u_epollfd;
+    //每轮事件循环刷新一次的粗粒度时钟,连接事件只用它记录活动时间
+    static time_t u_now;
+    //非epoll的事件后端(io_uring)接管连接fd的注册,op取EPOLL_CTL_ADD/MOD/DEL,DEL时由后端负责close
+    static void (*u_fd_hook)(int op, int fd, int ev);
+    //关闭连接前调用,协程引擎由此销毁该连接挂起的协程帧
+    static void (*u_drop_hook)(int fd);
     int m_TIMESLOT;
 };
 
+void cb_func(client_data *user_data);
+
 #endif /* __LST_TIMER_H__ */
\ No newline at end of file
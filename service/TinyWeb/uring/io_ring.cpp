@@ -0,0 +1,241 @@
+#include <sys/syscall.h> // for syscall 直接发起系统调用
+#include <sys/mman.h>    // POSIX 内存管理声明
+#include <unistd.h>      // for unistd POSIX 符号常量
+#include <string.h>      // for string 标准C库头文件,定义C语言字符串处理函数
+#include <stdlib.h>      // for stdlib 内存管理
+#include <errno.h>       // for errno
+#include <algorithm>     // for sort
+#include "io_ring.h"
+
+static int sys_io_uring_setup(unsigned entries, io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+io_ring::io_ring()
+    : m_fd(-1), m_sq_ptr(MAP_FAILED), m_sq_len(0), m_cq_ptr(MAP_FAILED), m_cq_len(0),
+      m_sqes((io_uring_sqe *)MAP_FAILED), m_sqes_len(0), m_sqe_tail(0),
+      m_bufs(nullptr), m_buf_count(0), m_buf_size(0), m_bgid(0)
+{
+}
+
+io_ring::~io_ring()
+{
+    free(m_bufs);
+    if (m_sqes != MAP_FAILED)
+    {
+        munmap(m_sqes, m_sqes_len);
+    }
+    if (m_cq_ptr != MAP_FAILED && m_cq_ptr != m_sq_ptr)
+    {
+        munmap(m_cq_ptr, m_cq_len);
+    }
+    if (m_sq_ptr != MAP_FAILED)
+    {
+        munmap(m_sq_ptr, m_sq_len);
+    }
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+}
+
+bool io_ring::init(unsigned entries)
+{
+    io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    m_fd = sys_io_uring_setup(entries, &p);
+    if (m_fd < 0)
+    {
+        return false;
+    }
+    m_sq_entries = p.sq_entries;
+    m_cq_entries = p.cq_entries;
+
+    m_sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    m_cq_len = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    //新内核 SQ 与 CQ 共用一次映射
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (m_cq_len > m_sq_len)
+        {
+            m_sq_len = m_cq_len;
+        }
+        m_cq_len = m_sq_len;
+    }
+    m_sq_ptr = mmap(0, m_sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+    if (m_sq_ptr == MAP_FAILED)
+    {
+        return false;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        m_cq_ptr = m_sq_ptr;
+    }
+    else
+    {
+        m_cq_ptr = mmap(0, m_cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+        if (m_cq_ptr == MAP_FAILED)
+        {
+            return false;
+        }
+    }
+    m_sqes_len = p.sq_entries * sizeof(io_uring_sqe);
+    m_sqes = (io_uring_sqe *)mmap(0, m_sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+    if (m_sqes == MAP_FAILED)
+    {
+        return false;
+    }
+
+    char *sq = (char *)m_sq_ptr;
+    m_sq_head = (unsigned *)(sq + p.sq_off.head);
+    m_sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    m_sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    m_sq_array = (unsigned *)(sq + p.sq_off.array);
+    //SQE 与 array 一一对应，之后只需推进 tail
+    for (unsigned i = 0; i < m_sq_entries; ++i)
+    {
+        m_sq_array[i] = i;
+    }
+    m_sqe_tail = *m_sq_tail;
+
+    char *cq = (char *)m_cq_ptr;
+    m_cq_head = (unsigned *)(cq + p.cq_off.head);
+    m_cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    m_cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    m_cqes = (io_uring_cqe *)(cq + p.cq_off.cqes);
+    return true;
+}
+
+bool io_ring::get_sqes(unsigned n, io_uring_sqe **sqes)
+{
+    unsigned head = __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+    if (m_sq_entries - (m_sqe_tail - head) < n)
+    {
+        //空位不足，先提交一批；已填写的都是完整的链
+        submit_and_wait(0);
+        head = __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+        if (m_sq_entries - (m_sqe_tail - head) < n)
+        {
+            return false;
+        }
+    }
+    for (unsigned i = 0; i < n; ++i)
+    {
+        io_uring_sqe *sqe = &m_sqes[m_sqe_tail & *m_sq_mask];
+        m_sqe_tail++;
+        memset(sqe, 0, sizeof(*sqe));
+        sqes[i] = sqe;
+    }
+    return true;
+}
+
+int io_ring::submit_and_wait(unsigned wait_nr)
+{
+    flush_bufs();
+    __atomic_store_n(m_sq_tail, m_sqe_tail, __ATOMIC_RELEASE);
+    //以内核已消费的位置计算，被信号打断后未提交的SQE会在下一次调用中补上
+    unsigned to_submit = m_sqe_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+    if (!to_submit && !wait_nr)
+    {
+        return 0;
+    }
+    int ret = sys_io_uring_enter(m_fd, to_submit, wait_nr, wait_nr ? IORING_ENTER_GETEVENTS : 0);
+    return ret < 0 ? -errno : ret;
+}
+
+io_uring_cqe *io_ring::peek_cqe()
+{
+    unsigned head = *m_cq_head;
+    if (head == __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE))
+    {
+        return nullptr;
+    }
+    return &m_cqes[head & *m_cq_mask];
+}
+
+void io_ring::cqe_seen()
+{
+    __atomic_store_n(m_cq_head, *m_cq_head + 1, __ATOMIC_RELEASE);
+}
+
+bool io_ring::setup_bufs(unsigned count, unsigned size, unsigned short bgid)
+{
+    m_buf_count = count;
+    m_buf_size = size;
+    m_bgid = bgid;
+    m_bufs = (char *)malloc((size_t)count * size);
+    if (!m_bufs)
+    {
+        return false;
+    }
+
+    //同步提供一次，顺带确认内核支持缓冲区选择
+    io_uring_sqe *sqe = get_sqe();
+    if (!sqe)
+    {
+        return false;
+    }
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = count;
+    sqe->addr = (unsigned long)m_bufs;
+    sqe->len = size;
+    sqe->off = 0;
+    sqe->buf_group = bgid;
+    if (submit_and_wait(1) < 0)
+    {
+        return false;
+    }
+    io_uring_cqe *cqe = peek_cqe();
+    bool ok = cqe && cqe->res >= 0;
+    if (cqe)
+    {
+        cqe_seen();
+    }
+    return ok;
+}
+
+void io_ring::recycle_buf(unsigned short bid)
+{
+    m_buf_pending.push_back(bid);
+}
+
+void io_ring::flush_bufs()
+{
+    if (m_buf_pending.empty())
+    {
+        return;
+    }
+    //get_sqe 在队列满时会重入 submit_and_wait，先换出待归还列表
+    m_buf_flush.swap(m_buf_pending);
+    std::sort(m_buf_flush.begin(), m_buf_flush.end());
+    size_t i = 0;
+    while (i < m_buf_flush.size())
+    {
+        size_t j = i + 1;
+        while (j < m_buf_flush.size() && m_buf_flush[j] == m_buf_flush[j - 1] + 1)
+        {
+            ++j;
+        }
+        io_uring_sqe *sqe = get_sqe();
+        if (!sqe)
+        {
+            m_buf_pending.insert(m_buf_pending.end(), m_buf_flush.begin() + i, m_buf_flush.end());
+            break;
+        }
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd = j - i;
+        sqe->addr = (unsigned long)buf_addr(m_buf_flush[i]);
+        sqe->len = m_buf_size;
+        sqe->off = m_buf_flush[i];
+        sqe->buf_group = m_bgid;
+        sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+        i = j;
+    }
+    m_buf_flush.clear();
+}
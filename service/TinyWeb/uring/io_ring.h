@@ -0,0 +1,129 @@
+/**
+ * @file io_ring.h
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief io_uring 的最小封装
+            ===============
+            不依赖 liburing，直接通过 io_uring_setup/io_uring_enter 系统调用使用内核接口.
+            > * 映射提交队列(SQ)、完成队列(CQ)与 SQE 数组
+            > * 批量提交：get_sqe 只在用户态填写，submit_and_wait 一次系统调用提交全部并等待完成
+            > * 内核托管的读缓冲区组(IORING_OP_PROVIDE_BUFFERS)，供 multishot recv 按需选取读缓冲区
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __IO_RING_H__
+#define __IO_RING_H__
+#include <linux/io_uring.h> // io_uring 内核接口定义
+#include <stddef.h>         // size_t
+#include <vector>           // stl vector容器
+
+class io_ring
+{
+public:
+    io_ring();
+    ~io_ring();
+
+    /**
+     * @brief 创建 io_uring 实例并映射队列
+     *
+     * @param entries SQ 长度，CQ 为其两倍
+     * @return true
+     * @return false 内核不支持或资源不足
+     */
+    bool init(unsigned entries);
+
+    /**
+     * @brief 取一个清零的 SQE，队列满时先把已填写的提交给内核
+     *
+     * @return io_uring_sqe* 提交后仍没有空位(如 CQ 溢出时 io_uring_enter 返回 -EBUSY)时为 nullptr
+     */
+    io_uring_sqe *get_sqe() { io_uring_sqe *sqe; return get_sqes(1, &sqe) ? sqe : nullptr; }
+    /**
+     * @brief 一次取 n 个连续的清零 SQE，供 IOSQE_IO_LINK 链使用
+              空位不足时先提交已填写的 SQE 再取，链不会被拆到两次提交中
+     *
+     * @param n
+     * @param sqes 输出
+     * @return false 提交后空位仍不足
+     */
+    bool get_sqes(unsigned n, io_uring_sqe **sqes);
+
+    /**
+     * @brief 提交所有已填写的 SQE，并至少等待 wait_nr 个完成事件
+     *
+     * @param wait_nr
+     * @return int 提交的个数，失败返回 -errno
+     */
+    int submit_and_wait(unsigned wait_nr);
+
+    /**
+     * @brief 取下一个完成事件，没有则返回 nullptr
+     *
+     * @return io_uring_cqe*
+     */
+    io_uring_cqe *peek_cqe();
+
+    /**
+     * @brief 标记 peek_cqe 返回的完成事件已处理
+     *
+     */
+    void cqe_seen();
+
+    /**
+     * @brief 向内核提供 count 个大小为 size 的读缓冲区，组号为 bgid
+     *
+     * @param count
+     * @param size
+     * @param bgid
+     * @return true
+     * @return false
+     */
+    bool setup_bufs(unsigned count, unsigned size, unsigned short bgid);
+    char *buf_addr(unsigned short bid) const { return m_bufs + (size_t)bid * m_buf_size; }
+    /**
+     * @brief 把缓冲区还给内核，累积到下次提交前按连续区间合并为 PROVIDE_BUFFERS
+     *
+     * @param bid
+     */
+    void recycle_buf(unsigned short bid);
+    /**
+     * @brief 立即为待归还的缓冲区填写 PROVIDE_BUFFERS，之后填写的 SQE 在内核中排在其后
+     *
+     */
+    void flush_bufs();
+
+private:
+
+    int m_fd;
+    unsigned m_sq_entries;
+    unsigned m_cq_entries;
+
+    void *m_sq_ptr;
+    size_t m_sq_len;
+    void *m_cq_ptr;
+    size_t m_cq_len;
+    io_uring_sqe *m_sqes;
+    size_t m_sqes_len;
+
+    unsigned *m_sq_head;
+    unsigned *m_sq_tail;
+    unsigned *m_sq_mask;
+    unsigned *m_sq_array;
+    unsigned m_sqe_tail;   //用户态已填写到的位置
+
+    unsigned *m_cq_head;
+    unsigned *m_cq_tail;
+    unsigned *m_cq_mask;
+    io_uring_cqe *m_cqes;
+
+    char *m_bufs;
+    unsigned m_buf_count;
+    unsigned m_buf_size;
+    unsigned short m_bgid;
+    std::vector<unsigned short> m_buf_pending; //待归还的缓冲区id
+    std::vector<unsigned short> m_buf_flush;
+};
+
+#endif /* __IO_RING_H__ */
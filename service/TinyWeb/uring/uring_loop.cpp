@@ -0,0 +1,889 @@
+#include <sys/eventfd.h> // for eventfd 工作线程唤醒事件循环
+#include <poll.h>        // POLLIN/POLLOUT
+#include <fcntl.h>       // for fcntl POSIX 文件控制
+#include "uring_loop.h"
+#include "../webserver.h"
+
+uring_loop *uring_loop::s_loop = nullptr;
+locker uring_loop::s_notify_lock;
+std::vector<uring_loop::notify_item> uring_loop::s_notify;
+
+//事件循环线程自己产生的通知不需要写eventfd
+static __thread bool t_in_loop = false;
+
+uring_loop::uring_loop(WebServer *server)
+    : m_server(server), m_conns(nullptr), m_stop(false), m_timeout(false), m_accept_armed(false), m_notify_armed(false),
+      m_signal_armed(false), m_rearm_recv(false),
+      m_notify_fd(-1), m_notify_val(0)
+{
+    m_close_log = server->m_close_log;
+}
+
+uring_loop::~uring_loop()
+{
+    if (s_loop == this)
+    {
+        Utils::u_fd_hook = nullptr;
+        s_loop = nullptr;
+    }
+    if (m_notify_fd >= 0)
+    {
+        close(m_notify_fd);
+    }
+    delete[] m_conns;
+}
+
+bool uring_loop::init()
+{
+    if (!m_ring.init(RING_ENTRIES))
+    {
+        return false;
+    }
+    if (!m_ring.setup_bufs(RECV_BUF_COUNT, RECV_BUF_SIZE, 0))
+    {
+        return false;
+    }
+    m_notify_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_notify_fd < 0)
+    {
+        return false;
+    }
+
+    m_conns = new ring_conn[MAX_FD];
+    for (int i = 0; i < MAX_FD; ++i)
+    {
+        ring_conn &c = m_conns[i];
+        c.gen = 0;
+        c.open = false;
+        c.closing = false;
+        c.busy = false;
+        c.recv_armed = false;
+        c.starved = false;
+        c.nodelay = false;
+        c.pipefd[0] = c.pipefd[1] = -1;
+    }
+
+    s_loop = this;
+    Utils::u_fd_hook = fd_hook;
+    return true;
+}
+
+void uring_loop::fd_hook(int op, int fd, int ev)
+{
+    notify_item item;
+    item.op = op;
+    item.fd = fd;
+    item.ev = ev;
+
+    s_notify_lock.lock();
+    bool was_empty = s_notify.empty();
+    s_notify.push_back(item);
+    s_notify_lock.unlock();
+
+    //队列非空说明已有人唤醒过事件循环
+    if (!t_in_loop && was_empty)
+    {
+        uint64_t one = 1;
+        ssize_t ret = write(s_loop->m_notify_fd, &one, sizeof(one));
+        (void)ret;
+    }
+}
+
+void uring_loop::run()
+{
+    t_in_loop = true;
+    arm_accept();
+    arm_notify();
+    arm_signal();
+
+    while (!m_stop)
+    {
+        int ret = m_ring.submit_and_wait(1);
+        Utils::u_now = time(NULL);
+        if (ret < 0 && ret != -EINTR)
+        {
+            LOG_ERROR("%s:errno is:%d", "io_uring_enter failure", -ret);
+            break;
+        }
+
+        io_uring_cqe *cqe;
+        while ((cqe = m_ring.peek_cqe()) != nullptr)
+        {
+            handle_cqe(cqe);
+            m_ring.cqe_seen();
+        }
+        drain_notify();
+
+        //过载时取消multishot accept,新连接留在backlog中;监听socket交出后不再accept
+        if (m_server->update_overload() && !m_server->m_draining)
+        {
+            if (m_server->m_overloaded)
+            {
+                cancel_accept();
+            }
+            else if (!m_accept_armed)
+            {
+                arm_accept();
+            }
+        }
+        if (m_server->m_draining)
+        {
+            if (m_accept_armed)
+            {
+                cancel_accept();
+            }
+            if (m_server->drain_done())
+            {
+                break;
+            }
+        }
+
+        if (m_timeout)
+        {
+            m_server->utils.timer_handler();
+            LOG_INFO("%s", "timer tick");
+            m_server->pool_stats();
+            m_timeout = false;
+        }
+        //SQ已满时未能提交的请求在每轮末尾重试
+        if (!m_notify_armed)
+        {
+            arm_notify();
+        }
+        if (!m_signal_armed)
+        {
+            arm_signal();
+        }
+        if (!m_accept_armed && !m_server->m_overloaded && !m_server->m_draining)
+        {
+            arm_accept();
+        }
+        rearm_starved();
+    }
+    t_in_loop = false;
+}
+
+void uring_loop::arm_accept()
+{
+    io_uring_sqe *sqe = m_ring.get_sqe();
+    if (!sqe)
+    {
+        LOG_ERROR("%s", "io_uring submission queue full, retry accept later");
+        return;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = m_server->m_listenfd;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = make_data(OP_ACCEPT, 0, m_server->m_listenfd);
+    m_accept_armed = true;
+}
+
+void uring_loop::cancel_accept()
+{
+    io_uring_sqe *sqe = m_ring.get_sqe();
+    if (!sqe)
+    {
+        //取消不了时accept继续进行，新连接由admit按过载状态回复503
+        LOG_ERROR("%s", "io_uring submission queue full, cannot cancel accept");
+        return;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = make_data(OP_ACCEPT, 0, m_server->m_listenfd);
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+    sqe->user_data = make_data(OP_CANCEL, 0, m_server->m_listenfd);
+}
+
+void uring_loop::arm_recv(int fd)
+{
+    ring_conn &c = m_conns[fd];
+    io_uring_sqe *sqe = m_ring.get_sqe();
+    if (!sqe)
+    {
+        //与缓冲区用尽一样等待重新提交
+        c.recv_armed = false;
+        if (!c.starved)
+        {
+            c.starved = true;
+            m_starved.push_back(fd);
+        }
+        m_rearm_recv = true;
+        return;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = 0;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->user_data = make_data(OP_RECV, c.gen, fd);
+    c.recv_armed = true;
+    c.starved = false;
+}
+
+void uring_loop::recycle(unsigned short bid)
+{
+    m_ring.recycle_buf(bid);
+    m_rearm_recv = true;
+}
+
+/**
+ * @brief 有缓冲区归还时重新提交因-ENOBUFS停下的recv,以及上一轮SQ已满未能提交的recv
+          先填写PROVIDE_BUFFERS再填写recv,内核按顺序执行,recv能用上刚归还的缓冲区
+ *
+ */
+void uring_loop::rearm_starved()
+{
+    if (!m_rearm_recv || m_starved.empty())
+    {
+        return;
+    }
+    m_rearm_recv = false;
+    m_ring.flush_bufs();
+    std::vector<int> starved;
+    starved.swap(m_starved);
+    for (size_t i = 0; i < starved.size(); ++i)
+    {
+        int fd = starved[i];
+        ring_conn &c = m_conns[fd];
+        //连接已关闭或已重新提交时starved已清除
+        if (c.starved && c.open && !c.recv_armed)
+        {
+            arm_recv(fd);
+        }
+    }
+}
+
+void uring_loop::arm_notify()
+{
+    io_uring_sqe *sqe = m_ring.get_sqe();
+    m_notify_armed = sqe != nullptr;
+    if (!sqe)
+    {
+        return;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = m_notify_fd;
+    sqe->addr = (unsigned long)&m_notify_val;
+    sqe->len = sizeof(m_notify_val);
+    sqe->off = (uint64_t)-1;
+    sqe->user_data = make_data(OP_NOTIFY, 0, m_notify_fd);
+}
+
+void uring_loop::arm_signal()
+{
+    io_uring_sqe *sqe = m_ring.get_sqe();
+    m_signal_armed = sqe != nullptr;
+    if (!sqe)
+    {
+        return;
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = m_server->m_pipefd[0];
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = make_data(OP_SIGNAL, 0, m_server->m_pipefd[0]);
+}
+
+/**
+ * @brief 处理工作线程与定时器产生的fd事件变更
+ *
+ */
+void uring_loop::drain_notify()
+{
+    s_notify_lock.lock();
+    m_notify_local.swap(s_notify);
+    s_notify_lock.unlock();
+
+    for (size_t i = 0; i < m_notify_local.size(); ++i)
+    {
+        const notify_item &item = m_notify_local[i];
+        ring_conn &c = m_conns[item.fd];
+        switch (item.op)
+        {
+        case EPOLL_CTL_ADD:
+        {
+            c.open = true;
+            c.closing = false;
+            c.busy = false;
+            c.nodelay = false;
+            c.stash.clear();
+            c.stash_off = 0;
+            arm_recv(item.fd);
+            break;
+        }
+        case EPOLL_CTL_MOD:
+        {
+            if (!c.open)
+            {
+                break;
+            }
+            if (item.ev & EPOLLOUT)
+            {
+                start_send(item.fd);
+            }
+            else if (item.ev & EPOLLIN)
+            {
+                //请求还不完整，继续接收
+                c.busy = false;
+                feed(item.fd, c);
+            }
+            break;
+        }
+        case EPOLL_CTL_DEL:
+        {
+            remove_conn(item.fd);
+            break;
+        }
+        }
+    }
+    m_notify_local.clear();
+}
+
+void uring_loop::handle_cqe(io_uring_cqe *cqe)
+{
+    uint64_t data = cqe->user_data;
+    int op = (int)(data >> 56);
+    uint32_t gen = (uint32_t)(data >> 32) & 0xffffff;
+    int fd = (int)(uint32_t)data;
+    bool more = cqe->flags & IORING_CQE_F_MORE;
+
+    switch (op)
+    {
+    case OP_ACCEPT:
+    {
+        if (cqe->res >= 0)
+        {
+            int connfd = cqe->res;
+            struct sockaddr_in client_address;
+            memset(&client_address, 0, sizeof(client_address));
+            //multishot accept不回填对端地址，只在需要写日志或按IP限流时查询
+            if (0 == m_close_log || http_conn::m_ip_limit > 0)
+            {
+                socklen_t len = sizeof(client_address);
+                getpeername(connfd, (struct sockaddr *)&client_address, &len);
+            }
+            m_server->admit(connfd, client_address);
+        }
+        else if (cqe->res != -ECANCELED)
+        {
+            LOG_ERROR("%s:errno is:%d", "accept error", -cqe->res);
+        }
+        if (!more)
+        {
+            m_accept_armed = false;
+            if (!m_server->m_overloaded)
+            {
+                arm_accept();
+            }
+        }
+        break;
+    }
+    case OP_RECV:
+    {
+        ring_conn &c = m_conns[fd];
+        if (!c.open || (c.gen & 0xffffff) != gen)
+        {
+            if (cqe->flags & IORING_CQE_F_BUFFER)
+            {
+                recycle(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+            }
+            break;
+        }
+        on_recv(fd, c, cqe);
+        break;
+    }
+    case OP_WRITEV:
+    case OP_SEND_HEADER:
+    case OP_SPLICE_IN:
+    case OP_SPLICE_OUT:
+    case OP_POLL_OUT:
+    {
+        ring_conn &c = m_conns[fd];
+        if (!c.open || (c.gen & 0xffffff) != gen)
+        {
+            break;
+        }
+        on_send_cqe(fd, c, op, cqe->res);
+        break;
+    }
+    case OP_CANCEL:
+    {
+        if (cqe->res < 0 && cqe->res != -ENOENT)
+        {
+            LOG_ERROR("%s:errno is:%d", "close error", -cqe->res);
+        }
+        break;
+    }
+    case OP_NOTIFY:
+    {
+        m_notify_armed = false;
+        arm_notify();
+        break;
+    }
+    case OP_SIGNAL:
+    {
+        bool flag = m_server->dealwithsignal(m_timeout, m_stop);
+        if (false == flag)
+        {
+            LOG_ERROR("%s", "dealclientdata failure");
+        }
+        if (!more)
+        {
+            m_signal_armed = false;
+            arm_signal();
+        }
+        break;
+    }
+    }
+}
+
+void uring_loop::on_recv(int fd, ring_conn &c, io_uring_cqe *cqe)
+{
+    int res = cqe->res;
+    if (!(cqe->flags & IORING_CQE_F_MORE))
+    {
+        c.recv_armed = false;
+    }
+
+    if (res > 0)
+    {
+        unsigned short bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+        c.stash.push_back(std::make_pair(bid, res));
+        if (!c.busy)
+        {
+            feed(fd, c);
+            if (!c.open)
+            {
+                return;
+            }
+        }
+    }
+    else if (res != -ENOBUFS)
+    {
+        //对端关闭或出错
+        close_conn(fd);
+        return;
+    }
+
+    if (!c.recv_armed && c.open)
+    {
+        //缓冲区用尽时立即重新提交只会反复得到-ENOBUFS,等有缓冲区归还再提交
+        if (res == -ENOBUFS)
+        {
+            if (!c.starved)
+            {
+                c.starved = true;
+                m_starved.push_back(fd);
+            }
+            return;
+        }
+        //内核结束了multishot，重新提交
+        arm_recv(fd);
+    }
+}
+
+/**
+ * @brief 把连接交给线程池处理
+ *
+ */
+void uring_loop::dispatch(int fd, ring_conn &c)
+{
+    c.busy = true;
+    LOG_INFO("deal with the client(%s)", inet_ntoa(m_server->users[fd].get_address()->sin_addr));
+    if (m_server->m_overloaded || !m_server->m_pool->append_p(m_server->users + fd))
+    {
+        m_server->send_busy(fd);
+        close_conn(fd);
+        return;
+    }
+    util_timer *timer = m_server->users_timer[fd].timer;
+    if (timer)
+    {
+        m_server->adjust_timer(timer);
+    }
+}
+
+/**
+ * @brief 把暂存的数据交给连接
+          读缓冲区装不下的部分继续暂存,等连接取走请求体后再交付,大请求体由此分批流过读缓冲区
+ *
+ */
+void uring_loop::feed(int fd, ring_conn &c)
+{
+    if (c.stash.empty())
+    {
+        return;
+    }
+    http_conn &conn = m_server->users[fd];
+    int fed = 0;
+    size_t i = 0;
+    for (; i < c.stash.size(); ++i)
+    {
+        int len = c.stash[i].second - c.stash_off;
+        int n = conn.read_from(m_ring.buf_addr(c.stash[i].first) + c.stash_off, len);
+        fed += n;
+        if (n < len)
+        {
+            c.stash_off += n;
+            break;
+        }
+        recycle(c.stash[i].first);
+        c.stash_off = 0;
+    }
+    c.stash.erase(c.stash.begin(), c.stash.begin() + i);
+    if (fed == 0)
+    {
+        //读缓冲区已被请求头占满
+        close_conn(fd);
+        return;
+    }
+    dispatch(fd, c);
+}
+
+void uring_loop::start_send(int fd)
+{
+    ring_conn &c = m_conns[fd];
+    http_conn &conn = m_server->users[fd];
+    struct iovec *iv = conn.get_iv();
+    int iv_count = conn.get_iv_count();
+
+    c.failed = false;
+    c.splice = false;
+    //部分响应的响应体没有映射(iov_base为空),只能从文件偏移处splice
+    if (iv_count == 2 && (iv[1].iov_len >= SPLICE_THRESHOLD || !iv[1].iov_base) && conn.get_file_fd() >= 0 &&
+        pipe2(c.pipefd, O_CLOEXEC) == 0)
+    {
+        c.splice = true;
+        //分段发送时由MSG_MORE/SPLICE_F_MORE合并报文，关闭Nagle以免最后一段等待对端的延迟确认
+        if (!c.nodelay)
+        {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            c.nodelay = true;
+        }
+        c.header_off = 0;
+        c.header_left = iv[0].iov_len;
+        c.file_fd = conn.get_file_fd();
+        c.file_off = conn.get_file_off();
+        c.file_left = iv[1].iov_len;
+        c.pipe_bytes = 0;
+        c.need_poll = false;
+        submit_splice_round(fd, c);
+        return;
+    }
+
+    c.iv_count = iv_count;
+    for (int i = 0; i < iv_count; ++i)
+    {
+        c.iv[i] = iv[i];
+    }
+    submit_writev(fd, c);
+}
+
+void uring_loop::submit_writev(int fd, ring_conn &c)
+{
+    io_uring_sqe *sqe = m_ring.get_sqe();
+    if (!sqe)
+    {
+        c.inflight = 0;
+        LOG_ERROR("%s", "io_uring submission queue full, close connection");
+        close_conn(fd);
+        return;
+    }
+    sqe->opcode = IORING_OP_WRITEV;
+    sqe->fd = fd;
+    sqe->addr = (unsigned long)c.iv;
+    sqe->len = c.iv_count;
+    sqe->off = (uint64_t)-1;
+    sqe->user_data = make_data(OP_WRITEV, c.gen, fd);
+    c.inflight = 1;
+}
+
+/**
+ * @brief 提交一轮链式发送: [等待可写] -> [响应头] -> [文件->管道] -> 管道->socket
+          链中任一步出错或不完整都会取消后续步骤，下一轮按剩余量重新提交
+ *
+ */
+void uring_loop::submit_splice_round(int fd, ring_conn &c)
+{
+    c.inflight = 0;
+    size_t out = c.pipe_bytes;
+    size_t rest = c.file_left;
+    bool fill = out == 0 && c.file_left;
+    if (fill)
+    {
+        out = c.file_left < SPLICE_CHUNK ? c.file_left : SPLICE_CHUNK;
+        rest -= out;
+    }
+
+    //整条链一次取出，SQ放不下时先提交之前的SQE，避免链被拆成两段、响应体先于响应头发出
+    io_uring_sqe *sqes[4];
+    unsigned n = (c.need_poll ? 1 : 0) + (c.header_left ? 1 : 0) + (fill ? 1 : 0) + (out ? 1 : 0);
+    if (n == 0)
+    {
+        return;
+    }
+    if (!m_ring.get_sqes(n, sqes))
+    {
+        LOG_ERROR("%s", "io_uring submission queue full, close connection");
+        close_conn(fd);
+        return;
+    }
+    unsigned k = 0;
+    io_uring_sqe *sqe;
+
+    if (c.need_poll)
+    {
+        sqe = sqes[k++];
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = fd;
+        sqe->poll32_events = POLLOUT;
+        sqe->flags = IOSQE_IO_LINK;
+        sqe->user_data = make_data(OP_POLL_OUT, c.gen, fd);
+        c.need_poll = false;
+    }
+    if (c.header_left)
+    {
+        struct iovec *iv = m_server->users[fd].get_iv();
+        sqe = sqes[k++];
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = fd;
+        sqe->addr = (unsigned long)((char *)iv[0].iov_base + c.header_off);
+        sqe->len = c.header_left;
+        //响应体紧随其后，避免响应头单独成段触发Nagle与延迟确认
+        sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL | MSG_MORE;
+        sqe->flags = IOSQE_IO_LINK;
+        sqe->user_data = make_data(OP_SEND_HEADER, c.gen, fd);
+    }
+    if (fill)
+    {
+        sqe = sqes[k++];
+        sqe->opcode = IORING_OP_SPLICE;
+        sqe->splice_fd_in = c.file_fd;
+        sqe->splice_off_in = c.file_off;
+        sqe->fd = c.pipefd[1];
+        sqe->off = (uint64_t)-1;
+        sqe->len = out;
+        sqe->splice_flags = SPLICE_F_MOVE;
+        sqe->flags = IOSQE_IO_LINK;
+        sqe->user_data = make_data(OP_SPLICE_IN, c.gen, fd);
+    }
+    if (out)
+    {
+        sqe = sqes[k++];
+        sqe->opcode = IORING_OP_SPLICE;
+        sqe->splice_fd_in = c.pipefd[0];
+        sqe->splice_off_in = (uint64_t)-1;
+        sqe->fd = fd;
+        sqe->off = (uint64_t)-1;
+        sqe->len = out;
+        sqe->splice_flags = SPLICE_F_MOVE | (rest ? SPLICE_F_MORE : 0);
+        sqe->user_data = make_data(OP_SPLICE_OUT, c.gen, fd);
+    }
+    sqes[n - 1]->flags &= ~IOSQE_IO_LINK;
+    c.inflight = n;
+}
+
+void uring_loop::on_send_cqe(int fd, ring_conn &c, int op, int res)
+{
+    c.inflight--;
+    if (op == OP_WRITEV)
+    {
+        if (res <= 0)
+        {
+            close_conn(fd);
+            return;
+        }
+        //跳过已发送的部分
+        size_t left = res;
+        while (left && c.iv_count)
+        {
+            if (left >= c.iv[0].iov_len)
+            {
+                left -= c.iv[0].iov_len;
+                c.iv[0] = c.iv[1];
+                c.iv_count--;
+            }
+            else
+            {
+                c.iv[0].iov_base = (char *)c.iv[0].iov_base + left;
+                c.iv[0].iov_len -= left;
+                left = 0;
+            }
+        }
+        if (c.iv_count && c.iv[0].iov_len == 0)
+        {
+            c.iv[0] = c.iv[1];
+            c.iv_count--;
+        }
+        if (c.iv_count)
+        {
+            submit_writev(fd, c);
+        }
+        else
+        {
+            finish_send(fd, c);
+        }
+        return;
+    }
+
+    switch (op)
+    {
+    case OP_POLL_OUT:
+    {
+        if (res < 0 && res != -ECANCELED)
+        {
+            c.failed = true;
+        }
+        break;
+    }
+    case OP_SEND_HEADER:
+    {
+        if (res > 0)
+        {
+            c.header_off += res;
+            c.header_left -= res;
+        }
+        else if (res != -ECANCELED)
+        {
+            c.failed = true;
+        }
+        break;
+    }
+    case OP_SPLICE_IN:
+    {
+        if (res > 0)
+        {
+            c.file_off += res;
+            c.file_left -= res;
+            c.pipe_bytes += res;
+        }
+        else if (res != -ECANCELED)
+        {
+            c.failed = true;
+        }
+        break;
+    }
+    case OP_SPLICE_OUT:
+    {
+        if (res > 0)
+        {
+            c.pipe_bytes -= res;
+        }
+        else if (res == -EAGAIN)
+        {
+            c.need_poll = true;
+        }
+        else if (res != -ECANCELED)
+        {
+            c.failed = true;
+        }
+        break;
+    }
+    }
+
+    if (c.inflight > 0)
+    {
+        return;
+    }
+    if (c.failed)
+    {
+        close_conn(fd);
+    }
+    else if (!c.header_left && !c.file_left && !c.pipe_bytes)
+    {
+        finish_send(fd, c);
+    }
+    else
+    {
+        submit_splice_round(fd, c);
+    }
+}
+
+void uring_loop::finish_send(int fd, ring_conn &c)
+{
+    release_send(c);
+    if (!m_server->users[fd].send_done())
+    {
+        close_conn(fd);
+        return;
+    }
+    LOG_INFO("send data to the client(%s)", inet_ntoa(m_server->users[fd].get_address()->sin_addr));
+    util_timer *timer = m_server->users_timer[fd].timer;
+    if (timer)
+    {
+        m_server->adjust_timer(timer);
+    }
+    c.busy = false;
+    feed(fd, c);
+}
+
+void uring_loop::release_send(ring_conn &c)
+{
+    //管道可能仍被内核中未完成的splice引用，直接关闭而不复用
+    if (c.pipefd[0] >= 0)
+    {
+        close(c.pipefd[0]);
+        close(c.pipefd[1]);
+        c.pipefd[0] = c.pipefd[1] = -1;
+    }
+}
+
+/**
+ * @brief 经由定时器关闭连接，与epoll路径的deal_timer一致
+ *
+ */
+void uring_loop::close_conn(int fd)
+{
+    ring_conn &c = m_conns[fd];
+    c.open = false;
+    util_timer *timer = m_server->users_timer[fd].timer;
+    m_server->deal_timer(timer, fd);
+}
+
+/**
+ * @brief 处理EPOLL_CTL_DEL: 取消该fd上所有未完成的请求后再close
+ *
+ */
+void uring_loop::remove_conn(int fd)
+{
+    ring_conn &c = m_conns[fd];
+    if (c.closing)
+    {
+        return;
+    }
+    c.closing = true;
+    c.open = false;
+    c.busy = false;
+    c.gen++;
+    for (size_t i = 0; i < c.stash.size(); ++i)
+    {
+        recycle(c.stash[i].first);
+    }
+    c.stash.clear();
+    c.stash_off = 0;
+    release_send(c);
+
+    //取消与关闭链在一起由内核依次执行，成功时都不产生CQE
+    io_uring_sqe *sqes[2];
+    if (!m_ring.get_sqes(2, sqes))
+    {
+        //shutdown使仍挂在该socket上的请求以出错结束，其CQE按代数丢弃
+        LOG_ERROR("%s", "io_uring submission queue full, close fd synchronously");
+        shutdown(fd, SHUT_RDWR);
+        close(fd);
+        return;
+    }
+    io_uring_sqe *sqe = sqes[0];
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = fd;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    sqe->flags = IOSQE_IO_HARDLINK | IOSQE_CQE_SKIP_SUCCESS;
+    sqe->user_data = make_data(OP_CANCEL, 0, fd);
+
+    sqe = sqes[1];
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = fd;
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+    sqe->user_data = make_data(OP_CANCEL, 0, fd);
+}
@@ -0,0 +1,159 @@
+/**
+ * @file uring_loop.h
+ * @author caogh (caoguanghuaplus@163.com)
+ * @brief 基于io_uring的事件循环
+            ===============
+            epoll之外可选的I/O后端(-i 1)，由事件循环完成所有socket读写，线程池只负责解析请求与生成响应(模拟Proactor).
+            > * multishot accept：一次提交持续接收新连接
+            > * multishot recv + IORING_OP_PROVIDE_BUFFERS提供的缓冲区组：不再每个请求重新注册EPOLLONESHOT，用过的缓冲区在下次提交前按连续区间合并归还
+            > * 缓冲区组用尽(-ENOBUFS)时recv不立即重提，等有缓冲区归还后再提交
+            > * 链式请求一次取出所需的全部SQE，不会被拆到两次提交中
+            > * 小响应用writev，大文件用 send(响应头) -> splice(文件->管道) -> splice(管道->socket) 链式提交
+            > * 每轮循环产生的SQE在下一次io_uring_enter中批量提交
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __URING_LOOP_H__
+#define __URING_LOOP_H__
+#include <sys/types.h>      // POSIX 基本系统数据类型
+#include <sys/uio.h>        // POSIX 矢量I/O操作
+#include <stdint.h>         // 定长整数
+#include <vector>           // stl vector容器
+#include "io_ring.h"        //自定义 io_uring封装
+#include "../lock/locker.h" //自定义 线程同步机制包装类
+
+class WebServer;
+
+class uring_loop
+{
+public:
+    static const unsigned RING_ENTRIES = 4096;      // SQ长度
+    static const unsigned RECV_BUF_COUNT = 4096;    //缓冲区组中缓冲区个数
+    static const unsigned RECV_BUF_SIZE = 2048;     //与http_conn::READ_BUFFER_SIZE一致
+    static const size_t SPLICE_THRESHOLD = 16384;   //响应体超过该大小时走splice
+    static const unsigned SPLICE_CHUNK = 65536;     //每轮经过管道的字节数
+
+    uring_loop(WebServer *server);
+    ~uring_loop();
+
+    /**
+     * @brief 创建io_uring实例与读缓冲区组，内核不支持时返回false由调用方回退到epoll
+     *
+     * @return true
+     * @return false
+     */
+    bool init();
+    void run();
+
+    /**
+     * @brief Utils::u_fd_hook 的实现，可在工作线程中调用
+     *
+     * @param op EPOLL_CTL_ADD/MOD/DEL
+     * @param fd
+     * @param ev EPOLLIN/EPOLLOUT
+     */
+    static void fd_hook(int op, int fd, int ev);
+
+private:
+    enum OP_TYPE
+    {
+        OP_ACCEPT = 1,
+        OP_RECV,
+        OP_WRITEV,
+        OP_SEND_HEADER,
+        OP_SPLICE_IN,
+        OP_SPLICE_OUT,
+        OP_POLL_OUT,
+        OP_CANCEL,
+        OP_NOTIFY,
+        OP_SIGNAL
+    };
+
+    /**
+     * @brief 事件循环侧的连接状态，与http_conn按fd一一对应
+     *
+     */
+    struct ring_conn
+    {
+        uint32_t gen;      //连接代数，区分复用同一fd的先后连接
+        bool open;
+        bool closing;      //已提交取消，等待取消完成后close
+        bool busy;         //请求在线程池中处理，期间收到的数据先暂存
+        bool recv_armed;
+        bool starved;      //recv因缓冲区用尽(-ENOBUFS)结束或SQ已满未能提交，在m_starved中等待重新提交
+        std::vector<std::pair<unsigned short, int> > stash; //暂存的(缓冲区id, 长度)
+        int stash_off;      //首个暂存缓冲区中已交给连接的字节数
+
+        struct iovec iv[2]; // writev剩余部分
+        int iv_count;
+        bool splice;        //是否走splice发送
+        bool nodelay;       //已设置TCP_NODELAY
+        size_t header_off;
+        size_t header_left;
+        int file_fd;
+        off_t file_off;
+        size_t file_left;
+        size_t pipe_bytes;  //管道中尚未发出的字节数
+        int pipefd[2];
+        bool need_poll;     // splice到socket返回EAGAIN，下一轮先等可写
+        int inflight;       //本轮尚未完成的CQE个数
+        bool failed;
+    };
+
+    struct notify_item
+    {
+        int op;
+        int fd;
+        int ev;
+    };
+
+    static uint64_t make_data(int op, uint32_t gen, int fd)
+    {
+        return ((uint64_t)op << 56) | ((uint64_t)(gen & 0xffffff) << 32) | (uint32_t)fd;
+    }
+
+    void arm_accept();
+    void cancel_accept();
+    void arm_recv(int fd);
+    void recycle(unsigned short bid);
+    void rearm_starved();
+    void arm_notify();
+    void arm_signal();
+    void drain_notify();
+    void handle_cqe(io_uring_cqe *cqe);
+    void on_recv(int fd, ring_conn &c, io_uring_cqe *cqe);
+    void dispatch(int fd, ring_conn &c);
+    void feed(int fd, ring_conn &c);
+    void start_send(int fd);
+    void submit_writev(int fd, ring_conn &c);
+    void submit_splice_round(int fd, ring_conn &c);
+    void on_send_cqe(int fd, ring_conn &c, int op, int res);
+    void finish_send(int fd, ring_conn &c);
+    void release_send(ring_conn &c);
+    void close_conn(int fd);
+    void remove_conn(int fd);
+
+    WebServer *m_server;
+    io_ring m_ring;
+    ring_conn *m_conns;
+    bool m_stop;
+    bool m_timeout;
+    bool m_accept_armed;
+    bool m_notify_armed;
+    bool m_signal_armed;
+    bool m_rearm_recv;               //本轮有缓冲区归还给内核，或有recv因SQ已满未能提交
+    std::vector<int> m_starved;      //等待重新提交recv的连接
+    int m_close_log;
+    int m_notify_fd;      // eventfd，工作线程通知事件循环
+    uint64_t m_notify_val;
+
+    static uring_loop *s_loop;
+    static locker s_notify_lock;
+    static std::vector<notify_item> s_notify;
+    std::vector<notify_item> m_notify_local;
+};
+
+#endif /* __URING_LOOP_H__ */
@@ -1,5 +1,13 @@
 #include "webserver.h"
 
+//过载时直接由主线程发出的预先生成的响应,不经过线程池与http_conn
+static const char busy_503_response[] = "HTTP/1.1 503 Service Unavailable\r\n"
+                                        "Content-Length:20\r\n"
+                                        "Retry-After:1\r\n"
+                                        "Connection:close\r\n"
+                                        "\r\n"
+                                        "Service Unavailable\n";
+
 WebServer::WebServer()
 {
     users = new http_conn[MAX_FD];
@@ -13,6 +21,9 @@ WebServer::WebServer()
     strcat(m_root, root);
 
     users_timer = new client_data[MAX_FD];
+    m_coro = nullptr;
+    m_pool = nullptr;
+    m_blocking_pool = nullptr;
 }
 
 WebServer::~WebServer()
@@ -33,13 +44,27 @@ WebServer::~WebServer()
     }
     if (m_pool != nullptr)
     {
-        delete[] m_pool;
+        delete m_pool;
         m_pool = nullptr;
     }
+    if (m_blocking_pool != nullptr)
+    {
+        delete m_blocking_pool;
+        m_blocking_pool = nullptr;
+    }
+    if (m_coro != nullptr)
+    {
+        delete m_coro;
+        m_coro = nullptr;
+    }
 }
 
 void WebServer::init(int port, string user, string passWord, string databaseName, int log_write,
-                     int opt_linger, int trigmode, int sql_num, int thread_num, int close_log, int actor_model)
+                     int opt_linger, int trigmode, int sql_num, int thread_num, int close_log, int actor_model,
+                     int backlog, int accept_batch, int defer_accept, int io_backend, int queue_size,
+                     int high_water, int low_water, int ip_limit, int compress_level,
+                     int body_chunks, int drain_timeout, const char *snapshot, int blocking_threads,
+                     int blocking_queue)
 {
     m_port = port;
     m_user = user;
@@ -52,6 +77,33 @@ void WebServer::init(int port, string user, string passWord, string databaseName
     m_TRIGMode = trigmode;
     m_close_log = close_log;
     m_actormodel = actor_model;
+    m_backlog = backlog;
+    m_accept_batch = accept_batch > 0 ? accept_batch : 1;
+    m_defer_accept = defer_accept;
+    m_accept_pending = false;
+    m_io_backend = io_backend;
+    m_queue_size = queue_size > 0 ? queue_size : 10000;
+    //水位以队列长度的百分比给出,至少相差1避免在同一深度上反复切换
+    m_high_water = m_queue_size * high_water / 100;
+    if (m_high_water < 1)
+    {
+        m_high_water = 1;
+    }
+    m_low_water = m_queue_size * low_water / 100;
+    if (m_low_water >= m_high_water)
+    {
+        m_low_water = m_high_water - 1;
+    }
+    m_overloaded = false;
+    http_conn::m_ip_limit = ip_limit;
+    m_compress_level = compress_level;
+    chunk_pool::get_instance()->init(body_chunks);
+    m_drain_timeout = drain_timeout;
+    m_draining = false;
+    m_drain_deadline = 0;
+    m_snapshot = snapshot;
+    m_blocking_threads = blocking_threads > 0 ? blocking_threads : sql_num;
+    m_blocking_queue = blocking_queue;
 }
 
 void WebServer::log_write()
@@ -70,65 +122,327 @@ void WebServer::log_write()
     }
 }
 
+void WebServer::precompress_files()
+{
+    //在开始服务前生成静态文件的压缩变体,之后请求线程只读
+    int count = precompress::build(m_root, m_compress_level);
+    if (count > 0)
+    {
+        LOG_INFO("precompressed %d files under %s", count, m_root);
+    }
+}
+
+void WebServer::route_table()
+{
+    http_conn::init_routes(m_root);
+}
+
 void WebServer::sql_pool()
 {
     //初始化数据库连接池
     m_connPool = connection_pool::GetInstance();
     m_connPool->init("localhost", m_user, m_passWord, m_databaseName, 3306, m_sql_num, m_close_log);
     //初始化数据库读取表
-    users->initmysql_result(m_connPool);
+    users->initmysql_result(m_connPool, m_close_log, m_snapshot);
+}
+
+void WebServer::save_users()
+{
+    //退出前把快照之后新增的行并入快照,下次启动只需映射文件
+    if (m_snapshot && !http_conn::save_users(m_connPool, m_snapshot))
+    {
+        LOG_ERROR("write user snapshot %s failed", m_snapshot);
+    }
 }
 
 void WebServer::thread_pool()
 {
     //线程池
-    m_pool = new thread_pool<http_conn>(m_actormodel, m_connPool, m_thread_num);
+    // io_uring后端由事件循环完成读写，工作线程只能按Proactor方式处理
+    //处理普通请求的线程不取数据库连接,访问数据库的处理函数交给单独的阻塞线程池,
+    //数据库变慢时只会占满阻塞线程池,静态资源请求不受影响
+    m_pool = new threadpool<http_conn>(1 == m_io_backend ? 0 : m_actormodel, nullptr, m_thread_num, m_queue_size);
+    m_blocking_pool = new threadpool<http_conn>(0, m_connPool, m_blocking_threads, m_blocking_queue);
+    http_conn::m_blocking_pool = m_blocking_pool;
 }
 
-void WebServer::eventListen()
+/**
+ * @brief 定时输出两个线程池的排队、执行与拒绝情况
+ *
+ */
+void WebServer::pool_stats()
+{
+    LOG_INFO("pool io: depth %d busy %d done %ld rejected %ld, blocking: depth %d busy %d done %ld rejected %ld",
+             m_pool->depth(), m_pool->busy(), m_pool->done(), m_pool->rejected(), m_blocking_pool->depth(),
+             m_blocking_pool->busy(), m_blocking_pool->done(), m_blocking_pool->rejected());
+}
+
+void WebServer::trig_mode()
+{
+    // LT + LT
+    if (0 == m_TRIGMode)
+    {
+        m_LISTENTrigmode = 0;
+        m_CONNTrigMode = 0;
+    }
+    // LT + ET
+    else if (1 == m_TRIGMode)
+    {
+        m_LISTENTrigmode = 0;
+        m_CONNTrigMode = 1;
+    }
+    // ET + LT
+    else if (2 == m_TRIGMode)
+    {
+        m_LISTENTrigmode = 1;
+        m_CONNTrigMode = 0;
+    }
+    // ET + ET
+    else if (3 == m_TRIGMode)
+    {
+        m_LISTENTrigmode = 1;
+        m_CONNTrigMode = 1;
+    }
+}
+
+/**
+ * @brief 平滑重启时交接监听socket用的Unix域抽象地址,按端口区分
+ *
+ */
+static socklen_t handoff_address(int port, struct sockaddr_un &addr)
+{
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    int len = snprintf(addr.sun_path + 1, sizeof(addr.sun_path) - 1, "tinyweb-%d", port);
+    return offsetof(struct sockaddr_un, sun_path) + 1 + len;
+}
+
+/**
+ * @brief 抽象地址没有文件权限保护,任何本地用户都能连上,交接前核对对端的有效uid与本进程相同
+ *
+ */
+static bool peer_is_self(int fd)
+{
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 && cred.uid == geteuid();
+}
+
+/**
+ * @brief 向同端口上正在运行的旧进程索取监听socket
+ *
+ * @return true 已通过SCM_RIGHTS取得m_listenfd
+ * @return false 没有旧进程,需自行bind
+ */
+bool WebServer::take_over_listen()
+{
+    struct sockaddr_un addr;
+    socklen_t addr_len = handoff_address(m_port, addr);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+    if (connect(fd, (struct sockaddr *)&addr, addr_len) < 0)
+    {
+        close(fd);
+        return false;
+    }
+    //地址可能被其他用户抢先绑定,不接收其发来的socket
+    if (!peer_is_self(fd))
+    {
+        LOG_ERROR("%s", "listen socket handoff refused: peer uid mismatch");
+        close(fd);
+        return false;
+    }
+
+    char byte;
+    struct iovec iov = {&byte, 1};
+    char control[CMSG_SPACE(sizeof(int))];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    //旧进程迟迟不交出时按全新启动处理
+    struct timeval tv = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    ssize_t n = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+    close(fd);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (n != 1 || !cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+    {
+        LOG_ERROR("%s", "listen socket handoff failed");
+        return false;
+    }
+    memcpy(&m_listenfd, CMSG_DATA(cmsg), sizeof(int));
+    LOG_INFO("took over listen socket on port %d", m_port);
+    return true;
+}
+
+/**
+ * @brief 等待新进程来取监听socket,交出后通过信号管道通知事件循环开始排空
+          在独立线程中阻塞accept,不占用事件循环
+ *
+ */
+void *WebServer::handoff_worker(void *arg)
 {
-    //网络编程基础步骤
-    m_listenfd = socket(PF_INET, SOCK_STREAM, 0);
-    assert(m_listenfd >= 0);
+    WebServer *server = (WebServer *)arg;
+    int m_close_log = server->m_close_log;
+    struct sockaddr_un addr;
+    socklen_t addr_len = handoff_address(server->m_port, addr);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    //刚接手时旧进程可能还没有关闭该地址,稍后重试
+    int tries = 0;
+    while (bind(fd, (struct sockaddr *)&addr, addr_len) < 0)
+    {
+        if (errno != EADDRINUSE || ++tries > 100)
+        {
+            LOG_ERROR("%s:errno is:%d", "handoff socket bind error", errno);
+            close(fd);
+            return nullptr;
+        }
+        usleep(100000);
+    }
+    listen(fd, 1);
 
-    //优雅关闭连接
-    if (0 == m_OPT_LINGER)
+    int conn;
+    for (;;)
     {
-        struct linger tmp = {0, 1};
-        setsockopt(m_listenfd, SOL_SOCKET, SO_LINGER, &tmp, sizeof(tmp));
+        conn = accept4(fd, NULL, NULL, SOCK_CLOEXEC);
+        if (conn < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        if (peer_is_self(conn))
+        {
+            break;
+        }
+        //其他用户的连接不交出监听socket,继续等待
+        LOG_WARN("%s", "handoff connection refused: peer uid mismatch");
+        close(conn);
     }
-    else if (1 == m_OPT_LINGER)
+    close(fd);
+    if (conn < 0)
     {
-        struct linger tmp = {1, 1};
-        setsockopt(m_listenfd, SOL_SOCKET, SO_LINGER, &tmp, sizeof(tmp));
+        return nullptr;
     }
 
+    char byte = 'L';
+    struct iovec iov = {&byte, 1};
+    char control[CMSG_SPACE(sizeof(int))];
+    memset(control, 0, sizeof(control));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &server->m_listenfd, sizeof(int));
+    bool sent = sendmsg(conn, &msg, MSG_NOSIGNAL) == 1;
+    close(conn);
+    if (sent)
+    {
+        //与信号处理函数一样写入一个字节,由dealwithsignal处理
+        char sig = SIGUSR2;
+        send(server->m_pipefd[1], &sig, 1, 0);
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 监听socket已交出: 停止accept,之后的响应不再保持长连接
+ *
+ */
+void WebServer::begin_drain()
+{
+    if (m_draining)
+    {
+        return;
+    }
+    m_draining = true;
+    m_drain_deadline = time(NULL) + m_drain_timeout;
+    http_conn::m_draining = true;
+    if (1 != m_io_backend)
+    {
+        set_listen(false);
+    }
+    LOG_INFO("listen socket handed off, draining %d connections", http_conn::m_user_count);
+}
+
+bool WebServer::drain_done()
+{
+    return m_draining && (http_conn::m_user_count <= 0 || time(NULL) >= m_drain_deadline);
+}
+
+void WebServer::eventListen()
+{
     int ret = 0;
-    struct sockaddr_in address;
-    bzero(&address, sizeof(address));
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = htonl(INADDR_ANY);
-    address.sin_port = htons(m_port);
-
-    int flag = 1;
-    setsockopt(m_listenfd, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
-    ret = bind(m_listenfd, (struct sockaddr *)&address, sizeof(address));
-    assert(ret >= 0);
-    ret = listen(m_listenfd, 5);
-    assert(ret >= 0);
+    //平滑重启: 同端口上有旧进程时直接接手其监听socket,全连接队列中的连接不会丢失
+    if (m_drain_timeout <= 0 || !take_over_listen())
+    {
+        //网络编程基础步骤
+        m_listenfd = socket(PF_INET, SOCK_STREAM, 0);
+        assert(m_listenfd >= 0);
+
+        //优雅关闭连接
+        if (0 == m_OPT_LINGER)
+        {
+            struct linger tmp = {0, 1};
+            setsockopt(m_listenfd, SOL_SOCKET, SO_LINGER, &tmp, sizeof(tmp));
+        }
+        else if (1 == m_OPT_LINGER)
+        {
+            struct linger tmp = {1, 1};
+            setsockopt(m_listenfd, SOL_SOCKET, SO_LINGER, &tmp, sizeof(tmp));
+        }
+
+        struct sockaddr_in address;
+        bzero(&address, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(m_port);
+
+        int flag = 1;
+        setsockopt(m_listenfd, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+        ret = bind(m_listenfd, (struct sockaddr *)&address, sizeof(address));
+        assert(ret >= 0);
+        //连接只有在客户端发来数据后才被accept,省掉一次空的读事件
+        if (m_defer_accept > 0)
+        {
+            setsockopt(m_listenfd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &m_defer_accept, sizeof(m_defer_accept));
+        }
+        ret = listen(m_listenfd, m_backlog);
+        assert(ret >= 0);
+    }
     utils.init(TIMESLOT);
+    utils.m_timer_lst.set_idle(3 * TIMESLOT);
 
     // epoll 创建内核事件表
     epoll_event events[MAX_EVENT_NUMBER];
     m_epollfd = epoll_create(5);
-    assert(m_epollfd != 1);
+    assert(m_epollfd != -1);
 
     utils.addfd(m_epollfd, m_listenfd, false, m_LISTENTrigmode);
     http_conn::m_epollfd = m_epollfd;
 
-    ret = socketpair(PE_UNIX, SOCK_STREAM, 0, m_pipefd);
-    assert(ret != 1);
-    utils.addfd(m_epollfd, m_pipefd, false, 0);
+    ret = socketpair(PF_UNIX, SOCK_STREAM, 0, m_pipefd);
+    assert(ret != -1);
+    utils.setnonblocking(m_pipefd[1]);
+    utils.addfd(m_epollfd, m_pipefd[0], false, 0);
 
     utils.addsig(SIGPIPE, SIG_IGN);
     utils.addsig(SIGALRM, utils.sig_handler, false);
@@ -138,7 +452,28 @@ void WebServer::eventListen()
 
     //工具类,信号和描述符基础操作
     Utils::u_pipefd = m_pipefd;
-    Utils::u_pipefd = m_epollfd;
+    Utils::u_epollfd = m_epollfd;
+
+    //协程引擎: 连接由事件循环线程中的协程处理,只有访问数据库的处理函数交给线程池
+    if (2 == m_actormodel && 1 != m_io_backend)
+    {
+        m_coro = new coro_loop(this);
+        if (!m_coro->init())
+        {
+            LOG_ERROR("%s", "coroutine engine unavailable (build with CORO=1), fall back to proactor");
+            delete m_coro;
+            m_coro = nullptr;
+        }
+    }
+
+    if (m_drain_timeout > 0)
+    {
+        pthread_t tid;
+        if (pthread_create(&tid, NULL, handoff_worker, this) == 0)
+        {
+            pthread_detach(tid);
+        }
+    }
 }
 
 void WebServer::timer(int connfd, struct sockaddr_in client_address)
@@ -149,78 +484,171 @@ void WebServer::timer(int connfd, struct sockaddr_in client_address)
     //创建定时器，设置回调函数和超时时间,绑定用户数据,将定时器放在链表中
     users_timer[connfd].address = client_address;
     users_timer[connfd].sockfd = connfd;
+    users_timer[connfd].conn = users + connfd;
     util_timer *timer = new util_timer;
     timer->user_data = &users_timer[connfd];
     timer->cb_func = cb_func;
-    time_t cur = time(NULL);
+    time_t cur = Utils::u_now;
+    timer->last_active = cur;
     timer->expire = cur + 3 * TIMESLOT;
     users_timer[connfd].timer = timer;
     utils.m_timer_lst.add_timer(timer);
 }
 
+/**
+ * @brief 记录连接活动,不移动定时器;到期时由sort_timer_lst::tick按活动时间续期
+ *
+ * @param timer
+ */
 void WebServer::adjust_timer(util_timer *timer)
 {
-    time_t cur = time(NULL);
-    timer->expire = cur + 3 * TIMESLOT;
-    utils.m_timer_lst.adjust_timer(timer);
-    LOG_INFO("%s", "adjust timer once");
+    timer->last_active = Utils::u_now;
 }
 
 void WebServer::deal_timer(util_timer *timer, int sockfd)
 {
-    timer->cb_func(&users_timer[sockfd];
-    if(timer){
-        utils.m_timer_lst.del_timer(timer);
+    //定时器已到期,连接已由tick关闭
+    if (!timer)
+    {
+        return;
     }
+    timer->cb_func(&users_timer[sockfd]);
+    utils.m_timer_lst.del_timer(timer);
+    users_timer[sockfd].timer = nullptr;
 
-    LOG_INFO("colse fd %d", user_timer[sockfd].sockfd);
+    LOG_INFO("colse fd %d", users_timer[sockfd].sockfd);
 }
 
+/**
+ * @brief 新连接的准入检查,通过后初始化连接与定时器,否则回复503并关闭
+ *
+ * @param connfd
+ * @param client_address
+ * @return true
+ * @return false 连接已被拒绝
+ */
+bool WebServer::admit(int connfd, struct sockaddr_in client_address)
+{
+    if (http_conn::m_user_count >= MAX_FD)
+    {
+        utils.show_error(connfd, "Internal server busy");
+        LOG_ERROR("%s", "Internal server busy");
+        return false;
+    }
+    if (m_overloaded || !http_conn::acquire_ip(client_address.sin_addr.s_addr))
+    {
+        send_busy(connfd);
+        close(connfd);
+        LOG_WARN("refuse client(%s): %s", inet_ntoa(client_address.sin_addr),
+                 m_overloaded ? "overloaded" : "too many connections");
+        return false;
+    }
+    timer(connfd, client_address);
+    if (m_coro)
+    {
+        m_coro->start(connfd);
+    }
+    return true;
+}
+
+void WebServer::send_busy(int sockfd)
+{
+    send(sockfd, busy_503_response, sizeof(busy_503_response) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+}
+
+/**
+ * @brief 按工作队列深度的高低水位更新过载状态
+ *
+ * @return true 状态发生了变化
+ * @return false
+ */
+bool WebServer::update_overload()
+{
+    int depth = m_pool->depth();
+    if (!m_overloaded && (depth >= m_high_water || http_conn::m_user_count >= MAX_FD))
+    {
+        m_overloaded = true;
+        LOG_WARN("overloaded, queue depth %d", depth);
+        return true;
+    }
+    if (m_overloaded && depth <= m_low_water && http_conn::m_user_count < MAX_FD)
+    {
+        m_overloaded = false;
+        LOG_INFO("recovered, queue depth %d", depth);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 过载时从epoll中去掉监听socket的EPOLLIN,新连接留在内核的全连接队列中
+ *
+ * @param enable
+ */
+void WebServer::set_listen(bool enable)
+{
+    epoll_event event;
+    event.data.fd = m_listenfd;
+    event.events = 0;
+    if (enable)
+    {
+        event.events = EPOLLIN | EPOLLRDHUP;
+        if (1 == m_LISTENTrigmode)
+        {
+            event.events |= EPOLLET;
+        }
+    }
+    epoll_ctl(m_epollfd, EPOLL_CTL_MOD, m_listenfd, &event);
+    // ET模式下暂停期间到达的连接不会再触发事件
+    m_accept_pending = enable && 1 == m_LISTENTrigmode;
+}
+
+/**
+ * @brief 接收新连接
+          accept4直接得到非阻塞的connfd,省掉setnonblocking的fcntl;
+          每次最多接收m_accept_batch个,避免建连高峰饿死已建立连接上的事件
+ *
+ * @return true
+ * @return false
+ */
 bool WebServer::dealclinetdata()
 {
     struct sockaddr_in client_address;
-    socket_t client_addrlength = sizeof(client_address);
-    if (0 == m_LISTENTrigmode)
+    socklen_t client_addrlength;
+    m_accept_pending = false;
+    for (int i = 0; i < m_accept_batch; ++i)
     {
-        int connfd = accept(m_listenfd, (struct sockaddr *)&client_address, &client_addrlength);
+        client_addrlength = sizeof(client_address);
+        int connfd = accept4(m_listenfd, (struct sockaddr *)&client_address, &client_addrlength,
+                             SOCK_NONBLOCK | SOCK_CLOEXEC);
         if (connfd < 0)
         {
-            LOG_ERROR("%s:errno is:%d", " accept error", errno);
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return true;
+            }
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            LOG_ERROR("%s:errno is:%d", "accept error", errno);
             return false;
         }
-        if (http_conn::m_user_count >= MAX_FD)
+        if (!admit(connfd, client_address) && http_conn::m_user_count >= MAX_FD)
         {
-            utils.show_error(connfd, "Internal server busy");
-            LOG_ERROR("%s", "Internal server busy");
             return false;
         }
-
-        timer(connfd, client_address);
     }
-    else
+
+    // ET模式不会再次通知,由eventLoop在处理完本轮事件后继续accept
+    if (1 == m_LISTENTrigmode)
     {
-        while (1)
-        {
-            int connfd = accept(m_listenfd, (struct sockaddr *)&client_address, &client_addrlength);
-            if (connfd < 0)
-            {
-                LOG_ERROR("%s:errno is:%d", "accept error", errno);
-                break;
-            }
-            if (http_conn::m_user_count >= MAX_FD)
-            {
-                utils.show_error(connfd, "Internal server busy");
-                LOG_ERROR("%s", "Internal server busy");
-                break;
-            }
-            timer(connfd, client_address);
-        }
-        return false;
+        m_accept_pending = true;
     }
     return true;
 }
 
-bool WebServer::dealwritesignal(bool &timeout, bool &stop_server)
+bool WebServer::dealwithsignal(bool &timeout, bool &stop_server)
 {
     int ret = 0;
     int signal = 0;
@@ -238,7 +666,7 @@ bool WebServer::dealwritesignal(bool &timeout, bool &stop_server)
     {
         for (int i = 0; i < ret; ++i)
         {
-            switch (signal[i])
+            switch (signals[i])
             {
             case SIGALRM:
             {
@@ -250,6 +678,11 @@ bool WebServer::dealwritesignal(bool &timeout, bool &stop_server)
                 stop_server = true;
                 break;
             }
+            case SIGUSR2:
+            {
+                begin_drain();
+                break;
+            }
             }
         }
     }
@@ -259,17 +692,30 @@ bool WebServer::dealwritesignal(bool &timeout, bool &stop_server)
 
 void WebServer::dealwithread(int sockfd)
 {
-    util_timer *timer = user_timer[sockfd].timer;
+    util_timer *timer = users_timer[sockfd].timer;
+
+    //协程引擎: 恢复等待该连接可读的协程
+    if (m_coro)
+    {
+        m_coro->resume(sockfd);
+        return;
+    }
 
     if (1 == m_actormodel)
     {
+        //队列已满时先读走请求再回复503,否则关闭时未读的数据会使对端收到RST
+        if (m_overloaded || !m_pool->append(users + sockfd, 0))
+        {
+            users[sockfd].read_once();
+            send_busy(sockfd);
+            deal_timer(timer, sockfd);
+            return;
+        }
         if (timer)
         {
             adjust_timer(timer);
         }
 
-        //若监测到读事件，将该事件放入请求队列
-        m_pool->append(users + sockfd, 0);
         while (true)
         {
             if (1 == users[sockfd].improv)
@@ -279,7 +725,7 @@ void WebServer::dealwithread(int sockfd)
                     deal_timer(timer, sockfd);
                     users[sockfd].timer_flag = 0;
                 }
-                user[sockfd].improv = 0;
+                users[sockfd].improv = 0;
                 break;
             }
         }
@@ -290,8 +736,13 @@ void WebServer::dealwithread(int sockfd)
         {
             LOG_INFO("deal with the client(%s)", inet_ntoa(users[sockfd].get_address()->sin_addr));
 
-            //若监测到读事件，将该事件放入请求队列
-            m_pool->append_p(users + sockfd);
+            //若监测到读事件，将该事件放入请求队列;过载或队列已满时直接回复503
+            if (m_overloaded || !m_pool->append_p(users + sockfd))
+            {
+                send_busy(sockfd);
+                deal_timer(timer, sockfd);
+                return;
+            }
 
             if (timer)
             {
@@ -308,6 +759,12 @@ void WebServer::dealwithread(int sockfd)
 void WebServer::dealwithwrite(int sockfd)
 {
     util_timer *timer = users_timer[sockfd].timer;
+
+    if (m_coro)
+    {
+        m_coro->resume(sockfd);
+        return;
+    }
     // reactor
     if (1 == m_actormodel)
     {
@@ -316,7 +773,12 @@ void WebServer::dealwithwrite(int sockfd)
             adjust_timer(timer);
         }
 
-        m_pool->append(users + sockfd, 1);
+        //响应已生成,写事件不受过载影响,队列满时只能关闭连接
+        if (!m_pool->append(users + sockfd, 1))
+        {
+            deal_timer(timer, sockfd);
+            return;
+        }
 
         while (true)
         {
@@ -356,24 +818,39 @@ void WebServer::eventLoop()
     bool timeout = false;
     bool stop_server = false;
 
+    if (1 == m_io_backend)
+    {
+        uring_loop loop(this);
+        if (loop.init())
+        {
+            loop.run();
+            return;
+        }
+        LOG_ERROR("%s", "io_uring unavailable, fall back to epoll");
+    }
+
     while (!stop_server)
     {
-        int number = epoll_wait(m_epollfd, events, MAX_EVENT_NUMBER, -1);
-        if (number < 0 && error != EINTR)
+        //还有未accept的连接时不阻塞,先处理已就绪的事件再继续accept;过载期间定期检查队列是否回落
+        int number = epoll_wait(m_epollfd, events, MAX_EVENT_NUMBER, m_accept_pending ? 0 : (m_overloaded ? 10 : -1));
+        Utils::u_now = time(NULL);
+        if (number < 0 && errno != EINTR)
         {
             LOG_ERROR("%s", "epoll failure");
             break;
         }
 
-        for (int i < 0; i < number; i++)
+        bool accepted = false;
+        for (int i = 0; i < number; i++)
         {
             int sockfd = events[i].data.fd;
 
             //处理新的客户端连接
             if (sockfd == m_listenfd)
             {
+                accepted = true;
                 bool flag = dealclinetdata();
-                if (false == false)
+                if (false == flag)
                 {
                     continue;
                 }
@@ -393,6 +870,11 @@ void WebServer::eventLoop()
                     LOG_ERROR("%s", "dealclientdata failure");
                 }
             }
+            else if (m_coro && sockfd == m_coro->notify_fd())
+            {
+                //线程池中的处理函数已完成
+                m_coro->complete();
+            }
             else if (events[i].events & EPOLLIN)
             {
                 dealwithread(sockfd);            //处理客户连接上接收到的数据
@@ -403,10 +885,25 @@ void WebServer::eventLoop()
             }
         }
 
-        if(timeout)[
+        if (m_accept_pending && !accepted)
+        {
+            dealclinetdata();
+        }
+
+        if (update_overload() && !m_draining)
+        {
+            set_listen(!m_overloaded);
+        }
+        if (drain_done())
+        {
+            break;
+        }
+
+        if(timeout){
             utils.timer_handler();
             LOG_INFO("%s", "timer tick");
+            pool_stats();
             timeout = false;
-        ]
+        }
     }
 }
\ No newline at end of file
@@ -10,9 +10,16 @@
 #include <stdlib.h>
 #include <cassert>
 #include <sys/epoll.h>
+#include <netinet/tcp.h>
+#include <sys/un.h>
+#include <pthread.h>
 
 #include "./threadpool/threadpool.h"
 #include "./http/http_conn.h"
+#include "./http/precompress.h"
+#include "./http/chunk_pool.h"
+#include "./uring/uring_loop.h"
+#include "./coro/coro_loop.h"
 using namespace std;
 const int MAX_FD = 65536;           //最大文件描述符
 const int MAX_EVENT_NUMBER = 10000; //最大事件数
@@ -25,19 +32,35 @@ public:
     ~WebServer();
     void init(int port, string user, string passWord, string databaseName,
               int log_write, int opt_linger, int trigmode, int sql_num,
-              int thread_num, int close_log, int actor_model);
+              int thread_num, int close_log, int actor_model, int backlog,
+              int accept_batch, int defer_accept, int io_backend, int queue_size,
+              int high_water, int low_water, int ip_limit, int compress_level,
+              int body_chunks, int drain_timeout, const char *snapshot, int blocking_threads,
+              int blocking_queue);
 
     void thread_pool();
+    void pool_stats();
     void sql_pool();
+    void save_users();
     void log_write();
+    void precompress_files();
+    void route_table();
     void trig_mode();
     void eventListen();
     void eventLoop();
     void timer(int connfd, struct sockaddr_in client_address);
-    void adjust_timer(util_timer *timer, int sockfd);
-    bool deal_timer(util_timer *timer, int sockfd);
+    void adjust_timer(util_timer *timer);
+    void deal_timer(util_timer *timer, int sockfd);
+    bool admit(int connfd, struct sockaddr_in client_address);
+    void send_busy(int sockfd);
+    bool update_overload();
+    void set_listen(bool enable);
     bool dealclinetdata();
-    bool dealwritesignal(bool &timeout, bool &stop_server);
+    bool dealwithsignal(bool &timeout, bool &stop_server);
+    bool take_over_listen();
+    static void *handoff_worker(void *arg);
+    void begin_drain();
+    bool drain_done();
     void dealwithread(int sockfd);
     void dealwithwrite(int sockfd);
 
@@ -68,6 +91,24 @@ public:
     int m_TRIGMode;
     int m_LISTENTrigmode;
     int m_CONNTrigMode;
+    int m_backlog;
+    int m_accept_batch;
+    int m_defer_accept;
+    bool m_accept_pending; // ET模式下本批次用完后仍可能有未accept的连接
+    int m_io_backend;      // 0为epoll，1为io_uring
+    int m_queue_size;      //工作队列长度
+    int m_high_water;      //队列深度达到该值时进入过载状态
+    int m_low_water;       //过载后队列深度降到该值时恢复
+    bool m_overloaded;     //过载期间暂停accept,新请求直接返回503
+    int m_compress_level;  //预压缩的gzip级别,0为不压缩
+    int m_drain_timeout;   //平滑重启时排空连接的最长秒数,0为不启用
+    bool m_draining;       //监听socket已交给新进程,等待已有连接处理完
+    time_t m_drain_deadline;
+    const char *m_snapshot; //用户表快照文件,nullptr为不使用
+    coro_loop *m_coro;      //协程引擎(-a 2),未启用时为nullptr
+    threadpool<http_conn> *m_blocking_pool; //执行访问数据库的处理函数
+    int m_blocking_threads;
+    int m_blocking_queue;
     
 
     client_data *users_timer;